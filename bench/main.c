@@ -0,0 +1,206 @@
+// Measures the overhead of the framework itself, using synthetic registries.
+// Usage: run_bench [max_case_count]
+#define TEST_IMPLEMENTATION
+#include <test/test.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// The case and suit sections must not be empty
+SUIT(bench, NULL, NULL);
+TEST(bench, empty) {}
+
+// Every benchmark performs roughly this many operations, regardless of the registry size
+#define BENCH_OPERATION_COUNT 1000000
+#define BENCH_CASES_PER_SUIT  100
+
+static void bench_empty_case(TEST_UNUSED test_intern_Result *_result) {}
+
+static struct {
+    uint32_t suit_count;
+    uint32_t case_count;
+    test_intern_SuitData *suits;
+    test_intern_TestCase *cases;
+    test_intern_SuitData **suit_pointers;
+    test_intern_TestCase **case_pointers;
+    char *names;
+} registry = { 0 };
+
+static void bench_registry_create(uint32_t case_count) {
+    registry.case_count = case_count;
+    registry.suit_count = (case_count + BENCH_CASES_PER_SUIT - 1) / BENCH_CASES_PER_SUIT;
+
+    registry.suits = test_calloc(registry.suit_count, sizeof(test_intern_SuitData));
+    registry.cases = test_calloc(registry.case_count, sizeof(test_intern_TestCase));
+    registry.suit_pointers = test_calloc(registry.suit_count, sizeof(test_intern_SuitData *));
+    registry.case_pointers = test_calloc(registry.case_count, sizeof(test_intern_TestCase *));
+    registry.names = test_calloc(registry.suit_count + registry.case_count, 16);
+
+    char *name = registry.names;
+    for (uint32_t i = 0; i < registry.suit_count; i++) {
+        snprintf(name, 16, "suit_%u", i);
+        registry.suits[i].name = name;
+        registry.suit_pointers[i] = &registry.suits[i];
+        name += 16;
+    }
+
+    for (uint32_t i = 0; i < registry.case_count; i++) {
+        snprintf(name, 16, "case_%u", i);
+        registry.cases[i].name = name;
+        registry.cases[i].line = i;
+        registry.cases[i].file_name = "bench/main.c";
+        registry.cases[i].suit_name = registry.suits[i / BENCH_CASES_PER_SUIT].name;
+        registry.cases[i].function = bench_empty_case;
+        registry.case_pointers[i] = &registry.cases[i];
+        name += 16;
+    }
+}
+
+static void bench_registry_destroy(void) {
+    free(registry.suits);
+    free(registry.cases);
+    free(registry.suit_pointers);
+    free(registry.case_pointers);
+    free(registry.names);
+    memset(&registry, 0, sizeof(registry));
+}
+
+static void bench_registry_register(void) {
+    if (!test_register_all(
+            registry.suit_pointers, registry.suit_pointers + registry.suit_count,
+            registry.case_pointers, registry.case_pointers + registry.case_count
+        )) {
+        fprintf(stderr, "[bench]: Failed to register synthetic cases\n");
+        exit(1);
+    }
+}
+
+static void
+bench_report(const char *name, uint32_t case_count, uint64_t operations, uint64_t elapsed_ns) {
+    printf(
+        "%-16s %8u cases %12.2f ns/op %14.0f op/s\n", name, case_count,
+        (double)elapsed_ns / (double)operations,
+        (elapsed_ns > 0) ? (double)operations * 1e9 / (double)elapsed_ns : 0
+    );
+}
+
+/// Times test_register_all(), the registration part of test_init(). Argument parsing is excluded
+static void bench_register(uint32_t case_count, uint32_t rounds) {
+    uint64_t elapsed_ns = 0;
+
+    for (uint32_t i = 0; i < rounds; i++) {
+        uint64_t start_time = test_time_now_ns();
+        bench_registry_register();
+        elapsed_ns += test_time_now_ns() - start_time;
+
+        test_register_free();
+    }
+
+    bench_report("register_all", case_count, (uint64_t)case_count * rounds, elapsed_ns);
+}
+
+static void bench_filter(uint32_t case_count, uint32_t rounds) {
+    static char filter[] = "suit_1*:case_*5,*:case_4?";
+    options.raw.filter_value = filter;
+    if (!test_parse_filter()) {
+        exit(1);
+    }
+
+    uint32_t matches = 0;
+    uint64_t start_time = test_time_now_ns();
+    for (uint32_t round = 0; round < rounds; round++) {
+        for (uint32_t i = 0; i < case_count; i++) {
+            matches += test_filter_case(registry.cases[i].suit_name, registry.cases[i].name);
+        }
+    }
+    bench_report(
+        "filter_case", case_count, (uint64_t)case_count * rounds, test_time_now_ns() - start_time
+    );
+
+    start_time = test_time_now_ns();
+    for (uint32_t round = 0; round < rounds; round++) {
+        for (uint32_t i = 0; i < case_count; i++) {
+            matches += test_wildcard_match(registry.cases[i].name, "case_*5");
+        }
+    }
+    bench_report(
+        "wildcard_match", case_count, (uint64_t)case_count * rounds,
+        test_time_now_ns() - start_time
+    );
+
+    free(options.filter_pattern_buffer);
+    options.filter_pattern_buffer = NULL;
+    options.filter_pattern_count = 0;
+
+    // Keep the results alive
+    if (matches == 0) {
+        fprintf(stderr, "[bench]: No filter matches\n");
+    }
+}
+
+static void bench_log_write(uint32_t case_count, uint32_t rounds) {
+    uint64_t start_time = test_time_now_ns();
+    for (uint32_t round = 0; round < rounds; round++) {
+        for (uint32_t i = 0; i < case_count; i++) {
+            test_log_write(
+                "failed at %d: %s:%s\n", registry.cases[i].line, registry.cases[i].suit_name,
+                registry.cases[i].name
+            );
+        }
+    }
+    bench_report(
+        "log_write", case_count, (uint64_t)case_count * rounds, test_time_now_ns() - start_time
+    );
+}
+
+static void bench_dispatch(uint32_t case_count, uint32_t rounds) {
+    uint64_t start_time = test_time_now_ns();
+    for (uint32_t round = 0; round < rounds; round++) {
+        for (uint32_t i = 0; i < case_count; i++) {
+            test_runner_run_test(
+                &registry.cases[i], registry.suit_pointers[i / BENCH_CASES_PER_SUIT]
+            );
+        }
+    }
+    bench_report(
+        "run_test", case_count, (uint64_t)case_count * rounds, test_time_now_ns() - start_time
+    );
+
+    memset(&test_runner, 0, sizeof(test_runner));
+}
+
+int main(int argc, char **argv) {
+    uint32_t max_case_count = 1000000;
+    if (argc > 1 && !test_parse_unsigned(argv[1], &max_case_count)) {
+        fprintf(stderr, "Usage: %s [max_case_count]\n", argv[0]);
+        return 1;
+    }
+
+    // Measure the library, not the terminal
+    options.output_stream = fopen("/dev/null", "w");
+    if (options.output_stream == NULL) {
+        perror("bench: ");
+        return 1;
+    }
+
+    static const uint32_t case_counts[] = { 1000, 100000, 1000000 };
+    for (uint32_t i = 0; i < sizeof(case_counts) / sizeof(case_counts[0]); i++) {
+        uint32_t case_count = case_counts[i];
+        if (case_count > max_case_count) {
+            break;
+        }
+
+        uint32_t rounds =
+            (case_count < BENCH_OPERATION_COUNT) ? BENCH_OPERATION_COUNT / case_count : 1;
+
+        bench_registry_create(case_count);
+        bench_register(case_count, rounds);
+        bench_filter(case_count, rounds);
+        bench_log_write(case_count, rounds);
+        bench_dispatch(case_count, rounds);
+        bench_registry_destroy();
+    }
+
+    fclose(options.output_stream);
+    return 0;
+}
@@ -4,6 +4,7 @@
 #define _GNU_SOURCE /* fileno() */
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -31,6 +32,7 @@
 #if defined(__clang__) || defined(__GNUC__)
     #define TEST_CASE_SECTION __attribute__((used, aligned(8), section("test_case_section")))
     #define TEST_SUIT_SECTION __attribute__((used, aligned(8), section("test_suit_section")))
+    #define TEST_FUZZ_SECTION __attribute__((used, aligned(8), section("test_fuzz_section")))
     #define TEST_UNUSED       __attribute__((unused))
 #else
     #error "Compiler not supported :^("
@@ -51,6 +53,55 @@
     #define TEST_LOG_BUFFER_SIZE 1024
 #endif
 
+/// The maximum size of a single fuzzing input
+#ifndef TEST_FUZZ_INPUT_SIZE_LIMIT
+    #define TEST_FUZZ_INPUT_SIZE_LIMIT 4096
+#endif
+
+/// The maximum number of fuzzing dictionary tokens
+#ifndef TEST_FUZZ_DICT_COUNT_LIMIT
+    #define TEST_FUZZ_DICT_COUNT_LIMIT 256
+#endif
+
+/// The maximum length of a single line of a fuzzing dictionary
+#ifndef TEST_FUZZ_DICT_LINE_LIMIT
+    #define TEST_FUZZ_DICT_LINE_LIMIT 1024
+#endif
+
+/// The maximum number of asynchronous test cases running at the same time
+#ifndef TEST_ASYNC_INFLIGHT_LIMIT
+    #define TEST_ASYNC_INFLIGHT_LIMIT 64
+#endif
+
+/// The maximum number of file descriptors watched by all running asynchronous test cases
+#ifndef TEST_ASYNC_WATCH_LIMIT
+    #define TEST_ASYNC_WATCH_LIMIT 1024
+#endif
+
+/// The size of the address space reserved for test_scratch_alloc(). Memory is only
+/// committed once it is used.
+#ifndef TEST_SCRATCH_SIZE
+    #define TEST_SCRATCH_SIZE (64 * 1024 * 1024)
+#endif
+
+/// The amount of stack and heap memory touched up front with '--mlock'
+#ifndef TEST_PREFAULT_STACK_SIZE
+    #define TEST_PREFAULT_STACK_SIZE (256 * 1024)
+#endif
+#ifndef TEST_PREFAULT_HEAP_SIZE
+    #define TEST_PREFAULT_HEAP_SIZE (8 * 1024 * 1024)
+#endif
+
+/// The number of times a test case is repeated with '--until-fail', unless specified otherwise
+#ifndef TEST_REPEAT_UNTIL_FAIL_DEFAULT
+    #define TEST_REPEAT_UNTIL_FAIL_DEFAULT 10000
+#endif
+
+/// The number of mutated inputs every fuzz target is executed with, unless specified otherwise
+#ifndef TEST_FUZZ_RUNS_DEFAULT
+    #define TEST_FUZZ_RUNS_DEFAULT 100000
+#endif
+
 /// Macro for creating a new suit
 /// @param suit_name The name of the new suit
 /// @param setup The name of the setup function. Called before every test
@@ -81,6 +132,60 @@
         &test_case_##test_name##_##suit_name_;                                 \
     static void test_##suit_name_##_##test_name(TEST_UNUSED test_intern_Result *_result)
 
+/// Macro for creating a new asynchronous test case.
+/// The body registers callbacks using 'test_async_watch()' and returns. The case is finished
+/// once 'test_async_done()' is called, an assertion fails, no watches are left or it timed out.
+/// All asynchronous test cases share a single epoll loop and run after the regular test cases.
+/// @param suit_name The name of the suit this test case should be added to.
+/// @param test_name The name of this test case
+/// @param timeout The timeout in milliseconds. Zero disables the timeout.
+#define ASYNC_TEST(suit_name_, test_name, timeout)                                      \
+    static void test_##suit_name_##_##test_name(test_intern_Result *_result);           \
+    static const test_intern_TestCase test_case_##test_name##_##suit_name_ = {          \
+        .name = #test_name,                                                             \
+        .line = __LINE__,                                                               \
+        .file_name = __FILE__,                                                          \
+        .suit_name = #suit_name_,                                                       \
+        .async_function = test_##suit_name_##_##test_name,                              \
+        .timeout_ms = (timeout)                                                         \
+    };                                                                                  \
+    TEST_CASE_SECTION                                                                   \
+    const test_intern_TestCase *test_case_ptr_##test_name##_##suit_name_ =              \
+        &test_case_##test_name##_##suit_name_;                                          \
+    static void test_##suit_name_##_##test_name(TEST_UNUSED test_intern_Result *_result)
+
+/// Macro for defining (or declaring) a callback for 'test_async_watch()'.
+/// Assertions can be used inside the callback.
+/// @param callback_name The name of the callback function
+#define ASYNC_CALLBACK(callback_name)                                                    \
+    static void callback_name(                                                           \
+        TEST_UNUSED test_intern_Result *_result, TEST_UNUSED int fd,                     \
+        TEST_UNUSED uint32_t events, TEST_UNUSED void *user_data                         \
+    )
+
+/// Macro for creating a new fuzz target. Fuzz targets are only executed with '--fuzz'.
+/// The body receives the current input as 'data' and 'size'.
+/// @param suit_name The name of the suit this fuzz target should be added to.
+/// @param fuzz_name The name of this fuzz target
+#define FUZZ(suit_name_, fuzz_name)                                                           \
+    static void test_fuzz_##suit_name_##_##fuzz_name(                                         \
+        test_intern_Result *_result, const uint8_t *data, size_t size                         \
+    );                                                                                        \
+    static const test_intern_FuzzCase test_fuzz_case_##fuzz_name##_##suit_name_ = {           \
+        .name = #fuzz_name,                                                                   \
+        .line = __LINE__,                                                                     \
+        .file_name = __FILE__,                                                                \
+        .suit_name = #suit_name_,                                                             \
+        .function = test_fuzz_##suit_name_##_##fuzz_name                                      \
+    };                                                                                        \
+    TEST_FUZZ_SECTION                                                                         \
+    const test_intern_FuzzCase *test_fuzz_case_ptr_##fuzz_name##_##suit_name_ =               \
+        &test_fuzz_case_##fuzz_name##_##suit_name_;                                           \
+    static void test_fuzz_##suit_name_##_##fuzz_name(                                         \
+        TEST_UNUSED test_intern_Result *_result, TEST_UNUSED const uint8_t *data,             \
+        TEST_UNUSED size_t size                                                               \
+    )
+
 #define TEST_CMP(type, lhs, rhs, macro, CMP_FUNC)                                       \
     do {                                                                                \
         if (!CMP_FUNC(lhs, rhs)) {                                                      \
@@ -137,6 +242,10 @@ typedef enum {
 typedef void (*test_TestFunction)(test_intern_Result *_state);
 typedef void (*test_SetupFunction)(void);
 typedef void (*test_TeardownFunction)(void);
+typedef void (*test_FuzzFunction)(test_intern_Result *_state, const uint8_t *data, size_t size);
+typedef void (*test_AsyncCallback)(
+    test_intern_Result *_state, int fd, uint32_t events, void *user_data
+);
 
 typedef struct {
     uint32_t line;
@@ -144,15 +253,28 @@ typedef struct {
     char *suit_name;
     char *file_name;
     test_TestFunction function;
+    // Only set for asynchronous test cases
+    test_TestFunction async_function;
+    uint32_t timeout_ms;
 } test_intern_TestCase;
 
+typedef struct {
+    uint32_t line;
+    char *name;
+    char *suit_name;
+    char *file_name;
+    test_FuzzFunction function;
+} test_intern_FuzzCase;
+
 typedef struct {
     char *name;
     test_SetupFunction setup_function;
     test_TeardownFunction teardown_function;
 } test_intern_SuitData;
 
-/// Initialize the testing framework
+/// Initialize the testing framework. Returns false if no tests should run, e.g. for '--help',
+/// '--list' or invalid arguments. Does not return for '--merge': the results are merged and
+/// the process exits with EXIT_FAILURE if any file was invalid or test case failed.
 extern bool test_init(int argc, char **argv);
 extern void test_exit(void);
 
@@ -167,17 +289,60 @@ __attribute__((format(printf, 1, 2))) extern void test_log_write(const char *for
 /// Run all tests, respecting filters specified on the commandline
 extern void test_run_all(void);
 
+/// Watch 'fd' for the epoll 'events' (EPOLLIN, EPOLLOUT, ...) on behalf of the currently
+/// running asynchronous test case. 'callback' is invoked whenever any of them occur.
+extern bool test_async_watch(int fd, uint32_t events, test_AsyncCallback callback, void *user_data);
+/// Stop watching 'fd'. Must be called before closing a watched file descriptor.
+extern void test_async_unwatch(int fd);
+/// Mark the currently running asynchronous test case as finished
+extern void test_async_done(void);
+
+/// Allocate 'size' bytes (16 byte aligned) of scratch memory. Can be used in test cases, fuzz
+/// targets and suit setup/teardown functions. All scratch memory is released at once after the
+/// test case finished. Asynchronous test cases that run at the same time use separate memory.
+/// Aborts if more than TEST_SCRATCH_SIZE bytes are used.
+extern void *test_scratch_alloc(size_t size);
+
 #endif // TEST_H_
 
 #ifdef TEST_IMPLEMENTATION
 
+#include <dirent.h> /* opendir, readdir */
 #include <errno.h>  /* errno */
-#include <malloc.h> /* malloc, calloc */
+#include <fcntl.h>  /* open */
+#include <limits.h> /* PATH_MAX */
+#include <link.h>   /* dl_iterate_phdr */
+#include <malloc.h> /* malloc, calloc, mallopt */
+#include <sched.h>  /* sched_setaffinity, sched_getcpu */
+#include <signal.h> /* sigaction, raise */
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdlib.h> /* abort, exit */
 #include <string.h> /* sterror, strcmp, memset */
-#include <unistd.h> /* isatty */
+#include <time.h>   /* clock_gettime */
+#include <unistd.h> /* isatty, fork */
+
+#include <linux/perf_event.h> /* perf_event_attr */
+#include <sys/epoll.h>         /* epoll_create1, epoll_ctl, epoll_wait */
+#include <sys/file.h>          /* flock */
+#include <sys/mman.h>          /* mmap, mlockall */
+#include <sys/resource.h>      /* getrusage, setpriority */
+#include <sys/stat.h>          /* stat */
+#include <sys/syscall.h>       /* SYS_perf_event_open */
+#include <sys/wait.h>          /* waitpid */
+
+#if defined(__SANITIZE_ADDRESS__)
+    #define TEST_HAS_ASAN
+#elif defined(__has_feature)
+    #if __has_feature(address_sanitizer)
+        #define TEST_HAS_ASAN
+    #endif
+#endif
+
+#ifdef TEST_HAS_ASAN
+    #include <sanitizer/asan_interface.h> /* __asan_poison_memory_region */
+    #include <sanitizer/common_interface_defs.h> /* __sanitizer_set_death_callback */
+#endif
 
 #include <ctype.h> /* isalnum */
 
@@ -194,6 +359,13 @@ extern test_intern_SuitData *__stop_test_suit_section;
     #define TEST_START_SUIT_SECTION (__start_test_suit_section)
     #define TEST_STOP_SUIT_SECTION  (__stop_test_suit_section)
 
+// Fuzz targets are optional. The section (and its symbols) only exist if at least
+// one target was defined
+extern test_intern_FuzzCase *__start_test_fuzz_section __attribute__((weak));
+extern test_intern_FuzzCase *__stop_test_fuzz_section __attribute__((weak));
+    #define TEST_START_FUZZ_SECTION (__start_test_fuzz_section)
+    #define TEST_STOP_FUZZ_SECTION  (__stop_test_fuzz_section)
+
 #else
     #error "Compiler not supported :^("
 #endif
@@ -208,15 +380,158 @@ extern test_intern_SuitData *__stop_test_suit_section;
 typedef struct {
     uint32_t test_count;
     const test_intern_TestCase **test_list;
+    uint32_t fuzz_count;
+    const test_intern_FuzzCase **fuzz_list;
     const test_intern_SuitData *suit_data;
+    // The most scratch memory used by a single test case of this suit
+    uint64_t scratch_high_water;
 } test_intern_Suit;
 
 static struct {
     uint32_t total_suits;
     uint32_t total_tests;
+    uint32_t total_fuzz_targets;
     test_intern_Suit *suit_list;
 } test_register = { 0 };
 
+typedef struct {
+    uint32_t length;
+    char buffer[TEST_LOG_BUFFER_SIZE];
+} test_intern_LogCapture;
+
+// Measurements of a single run of a test case
+typedef struct {
+    uint64_t duration_ns;
+    uint64_t scratch_bytes;
+    // Only measured with '--noise'
+    uint64_t voluntary_switches;
+    uint64_t involuntary_switches;
+    uint64_t migrations;
+} test_intern_RunSample;
+
+// Statistics of a repeated test case
+typedef struct {
+    // Measured runs. Runs interrupted by a crashing worker are only counted as failed results
+    uint32_t runs;
+    uint32_t crashed_runs;
+    uint32_t results[test_intern_ResultCount];
+    uint64_t min_ns;
+    uint64_t max_ns;
+    // Running mean and sum of squared differences, see:
+    // https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance#Welford's_online_algorithm
+    double mean_ns;
+    double m2_ns;
+    // The most scratch memory used by a single run
+    uint64_t scratch_bytes;
+    // Sums of all runs, only measured with '--noise'
+    uint64_t voluntary_switches;
+    uint64_t involuntary_switches;
+    uint64_t migrations;
+    // Log output of the first failed run
+    test_intern_LogCapture failure;
+} test_intern_RepeatStats;
+
+// Compact, append only results format written by '--results'. All values are stored
+// in host byte order. A file starts with a header, followed by any number of records.
+// Every record is followed by the NUL terminated file, suit, case and message strings,
+// and padded to a multiple of 8 bytes.
+#define TEST_RESULTS_MAGIC   "LTRS"
+#define TEST_RESULTS_VERSION 1
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t record_size;
+} test_intern_ResultsHeader;
+
+typedef struct {
+    // Size of the record, including the strings following it
+    uint32_t size;
+    uint32_t line;
+    uint32_t runs;
+    uint32_t failures;
+    // Sum and maximum over all runs
+    uint64_t duration_ns;
+    uint64_t duration_max_ns;
+    uint16_t file_length;
+    uint16_t suit_length;
+    uint16_t case_length;
+    uint16_t message_length;
+    // Relative to the start of the record, zero if there is no message
+    uint32_t message_offset;
+    uint8_t status;
+    uint8_t reserved[3];
+} test_intern_ResultRecord;
+
+typedef enum {
+    test_intern_MergeReport,
+    test_intern_MergeText,
+    test_intern_MergeJson,
+} test_intern_MergeFormat;
+
+static struct {
+    int fd;
+    uint32_t buffer_size;
+    uint8_t *buffer;
+
+    // Used by '--merge'
+    uint32_t record_count;
+    bool has_merge_errors;
+} test_results = { .fd = -1 };
+
+typedef struct {
+    char *path;
+    uint64_t mtime_ns;
+    uint64_t size;
+    uint64_t hash;
+    bool is_changed;
+} test_intern_SourceFile;
+
+typedef struct {
+    // 'suit:case'
+    char *name;
+    uint8_t status;
+} test_intern_CachedCase;
+
+// Open addressing hash index. Maps a key hash to an index into a separate array
+typedef struct {
+    uint32_t capacity;
+    // Index + 1. Zero marks an empty slot
+    uint32_t *slots;
+} test_intern_HashIndex;
+
+// Status of test cases that did not run yet
+#define TEST_CHANGES_STATUS_UNKNOWN 0xff
+
+static struct {
+    char *cache_path;
+
+    // State as read from the cache
+    bool has_cached_binary;
+    uint64_t cached_binary_hash;
+    uint32_t cached_file_count;
+    test_intern_SourceFile *cached_files;
+    test_intern_HashIndex cached_file_index;
+    uint32_t cached_case_count;
+    test_intern_CachedCase *cached_cases;
+    test_intern_HashIndex cached_case_index;
+
+    // State of this run
+    uint64_t binary_hash;
+    uint32_t file_count;
+    test_intern_SourceFile *files;
+    test_intern_HashIndex file_index;
+    uint32_t case_count;
+    uint32_t selected_count;
+    const test_intern_TestCase **cases;
+    const test_intern_SuitData **suits;
+    uint8_t *statuses;
+    bool *is_selected;
+    // Indexed by the address of the test case
+    test_intern_HashIndex case_index;
+} test_changes = { 0 };
+
 static struct {
     uint32_t tests_successful;
     uint32_t tests_attempted;
@@ -225,14 +540,105 @@ static struct {
     uint32_t tests_skipped;
     uint32_t suits_failed;
     uint32_t suits_skipped;
+
+    // Test cases executed with '--repeat' or '--until-fail'
+    uint32_t repeat_count;
+    const test_intern_TestCase **repeat_tests;
+    const test_intern_SuitData **repeat_suits;
+    test_intern_RepeatStats *repeat_stats;
 } test_runner = { 0 };
 
 static struct {
     uint32_t length;
     uint32_t offset;
     char buffer[TEST_LOG_BUFFER_SIZE];
+
+    // If set, messages are appended to this buffer instead of being written out
+    test_intern_LogCapture *capture;
+    // Messages are written out and additionally appended to 'capture'
+    bool is_capture_streamed;
 } log_data = { 0 };
 
+typedef struct {
+    const test_intern_TestCase *test;
+    const test_intern_SuitData *suit;
+} test_intern_AsyncPending;
+
+typedef struct {
+    // Reserved on first use
+    uint8_t *base;
+    uint64_t used;
+} test_intern_ScratchArena;
+
+typedef struct {
+    bool is_active;
+    bool is_done;
+    uint32_t watch_count;
+    uint64_t start_time;
+    uint64_t deadline;
+    test_intern_Result result;
+    const test_intern_TestCase *test;
+    const test_intern_SuitData *suit;
+    test_intern_LogCapture log;
+    // Overlapping test cases each release their scratch memory once they finished
+    test_intern_ScratchArena scratch;
+} test_intern_AsyncSlot;
+
+typedef struct {
+    int fd;
+    // Incremented on every reuse, to detect stale events
+    uint32_t generation;
+    test_intern_AsyncSlot *slot;
+    test_AsyncCallback callback;
+    void *user_data;
+} test_intern_AsyncWatch;
+
+static struct {
+    int epoll_fd;
+    uint32_t active_count;
+    test_intern_AsyncSlot *current;
+
+    uint32_t pending_count;
+    test_intern_AsyncPending *pending;
+
+    test_intern_AsyncSlot slots[TEST_ASYNC_INFLIGHT_LIMIT];
+    test_intern_AsyncWatch watches[TEST_ASYNC_WATCH_LIMIT];
+} test_async = { 0 };
+
+typedef struct {
+    uint32_t size;
+    uint8_t *data;
+} test_intern_FuzzInput;
+
+// Shared between all fuzzing workers
+typedef struct {
+    uint64_t execs;
+    uint32_t targets;
+    uint32_t crashes;
+} test_intern_FuzzStats;
+
+static struct {
+    uint64_t random_state;
+    uint32_t worker_index;
+    test_intern_FuzzStats *stats;
+
+    uint32_t corpus_count;
+    test_intern_FuzzInput *corpus;
+    uint32_t dict_count;
+    test_intern_FuzzInput dict[TEST_FUZZ_DICT_COUNT_LIMIT];
+
+    // Inputs are mutated in 'mutation_buffer' and then copied to the end of 'input_buffer'.
+    // This way, reading past the end of an input is still caught by the sanitizers
+    uint8_t *mutation_buffer;
+    uint8_t *input_buffer;
+
+    // The input that is currently being executed. Used by the crash handler
+    const uint8_t *volatile current_data;
+    volatile uint32_t current_size;
+    char crash_name[TEST_FILTER_SIZE_LIMIT * 2];
+    char crash_path[TEST_FILTER_SIZE_LIMIT * 2 + 32];
+} test_fuzzer = { 0 };
+
 static struct {
     bool colored;
     bool show_help;
@@ -244,6 +650,17 @@ static struct {
         char *colored_value;
         char *output_value;
         char *filter_value;
+        char *jobs_value;
+        char *fuzz_value;
+        char *fuzz_runs_value;
+        char *fuzz_dict_value;
+        char *repeat_value;
+        char *results_value;
+        char *merge_value;
+        char *merge_format_value;
+        char *changed_since_value;
+        char *cpus_value;
+        char *nice_value;
     } raw;
 
     FILE *output_stream;
@@ -254,6 +671,21 @@ static struct {
     char *filter_pattern[TEST_FILTER_COUNT_LIMIT];
     char *filter_pattern_buffer;
     uint32_t filter_pattern_count;
+
+    uint32_t jobs;
+    test_intern_MergeFormat merge_format;
+    uint32_t repeat;
+    bool until_fail;
+    bool scratch_poison;
+    // CPUs selected with '--cpus', in the order they were specified
+    uint32_t cpu_count;
+    uint16_t cpu_list[CPU_SETSIZE];
+    cpu_set_t cpu_set;
+    bool mlock;
+    bool noise;
+    int32_t nice;
+    char *fuzz_corpus;
+    uint32_t fuzz_runs;
 } options = { 0 };
 
 static inline void *test_realloc(void *base, uintptr_t size) {
@@ -276,151 +708,1686 @@ static inline void *test_calloc(uint64_t nmem, uint64_t smem) {
     return result;
 }
 
+static inline uint64_t test_time_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+#define TEST_HASH_FNV1A_INIT 0xcbf29ce484222325ULL
+
+// 64 bit FNV-1a, see: http://www.isthe.com/chongo/tech/comp/fnv/index.html
+// Continues hashing from 'hash', which allows hashing data in chunks.
+// Must stay async signal safe, it is used by the fuzzers crash handler
+static inline uint64_t test_hash_fnv1a_update(uint64_t hash, const uint8_t *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+static inline uint64_t test_hash_fnv1a(const uint8_t *data, size_t size) {
+    return test_hash_fnv1a_update(TEST_HASH_FNV1A_INIT, data, size);
+}
+
+static inline uint64_t test_hash_string(const char *text) {
+    return test_hash_fnv1a((const uint8_t *)text, strlen(text));
+}
+
+static inline uint64_t test_hash_pointer(const void *pointer) {
+    uintptr_t address = (uintptr_t)pointer;
+    return test_hash_fnv1a((const uint8_t *)&address, sizeof(address));
+}
+
+static bool test_parse_unsigned(const char *text, uint32_t *value) {
+    test_intern_assert(text != NULL);
+    test_intern_assert(value != NULL);
+
+    char *end = NULL;
+    errno = 0;
+    unsigned long long result = strtoull(text, &end, 10);
+    if (errno != 0 || end == text || *end != '\0' || text[0] == '-' || result > UINT32_MAX) {
+        return false;
+    }
+
+    *value = (uint32_t)result;
+    return true;
+}
+
+/// Parse a list of CPUs like '0-3,6' into 'options.cpu_list' and 'options.cpu_set'
+static bool test_parse_cpus(const char *text) {
+    CPU_ZERO(&options.cpu_set);
+    options.cpu_count = 0;
+
+    const char *iter = text;
+    while (true) {
+        char *end = NULL;
+        if (!isdigit((unsigned char)*iter)) {
+            return false;
+        }
+        unsigned long first = strtoul(iter, &end, 10);
+        unsigned long last = first;
+
+        if (*end == '-') {
+            iter = end + 1;
+            if (!isdigit((unsigned char)*iter)) {
+                return false;
+            }
+            last = strtoul(iter, &end, 10);
+        }
+
+        if (first > last || last >= CPU_SETSIZE) {
+            return false;
+        }
+
+        for (unsigned long cpu = first; cpu <= last; cpu++) {
+            if (!CPU_ISSET(cpu, &options.cpu_set)) {
+                CPU_SET(cpu, &options.cpu_set);
+                options.cpu_list[options.cpu_count++] = (uint16_t)cpu;
+            }
+        }
+
+        if (*end == '\0') {
+            return true;
+        } else if (*end != ',') {
+            return false;
+        }
+        iter = end + 1;
+    }
+}
+
 static inline void test_log_clear(void) { log_data.offset = 0; }
 
+/// Append 'text' to a capture. If it does not fit, the capture is restarted,
+/// so that it holds the most recent output (which includes the assertion message).
+static void test_log_capture_append(test_intern_LogCapture *capture, const char *text) {
+    uint32_t length = (uint32_t)strnlen(text, TEST_LOG_BUFFER_SIZE - 1);
+    if (capture->length + length >= TEST_LOG_BUFFER_SIZE) {
+        capture->length = 0;
+    }
+
+    memcpy(capture->buffer + capture->length, text, length);
+    capture->length += length;
+    capture->buffer[capture->length] = '\0';
+}
+
 __attribute__((format(printf, 1, 2))) void test_log_write(const char *format, ...) {
     test_intern_assert(format != NULL);
 
     va_list args;
     va_start(args, format);
+
     vsnprintf(
         log_data.buffer + log_data.offset, TEST_LOG_BUFFER_SIZE - log_data.offset, format, args
     );
     va_end(args);
 
-    fprintf(options.output_stream, "%s", log_data.buffer);
+    // Captures that are not streamed are printed later, e.g. by asynchronous test cases
+    if (log_data.capture == NULL || log_data.is_capture_streamed) {
+        fprintf(options.output_stream, "%s", log_data.buffer);
+    }
+    if (log_data.capture != NULL) {
+        test_log_capture_append(log_data.capture, log_data.buffer);
+    }
     test_log_clear();
 }
 
-/* Test runner */
-static void test_runner_report(void) {
-    uint32_t failed_percent = (test_runner.tests_failed > 0)
-                                  ? (test_runner.tests_failed * 100 / test_register.total_tests)
-                                  : 0;
-    uint32_t skipped_percent = (test_runner.tests_skipped > 0)
-                                   ? (test_runner.tests_skipped * 100 / test_register.total_tests)
-                                   : 0;
-    uint32_t success_percent =
-        (test_runner.tests_successful) > 0
-            ? (test_runner.tests_successful * 100 / test_register.total_tests)
-            : 0;
-    uint32_t partial_percent = (test_runner.tests_partially > 0)
-                                   ? (test_runner.tests_partially * 100 / test_register.total_tests)
-                                   : 0;
+/* Change tracking */
+static void test_hash_index_init(test_intern_HashIndex *index, uint32_t count) {
+    index->capacity = 16;
+    while (index->capacity < count * 2) {
+        index->capacity *= 2;
+    }
 
-    test_log_write(
-        "attempted to run %d out of %d tests\n", test_runner.tests_attempted,
-        test_register.total_tests
-    );
-    test_log_write("successful: %u - %3u%%\n", test_runner.tests_successful, success_percent);
-    test_log_write("failed    : %u - %3u%%\n", test_runner.tests_failed, failed_percent);
-    test_log_write("partially : %u - %3u%%\n", test_runner.tests_partially, partial_percent);
-    test_log_write("skipped   : %u - %3u%%\n", test_runner.tests_skipped, skipped_percent);
+    index->slots = test_calloc(index->capacity, sizeof(uint32_t));
 }
 
-static void
-test_runner_run_test(const test_intern_TestCase *test, const test_intern_SuitData *suit) {
-    test_intern_assert(test != NULL);
-    test_intern_assert(suit != NULL);
+static void test_hash_index_insert(test_intern_HashIndex *index, uint64_t hash, uint32_t value) {
+    uint32_t slot = (uint32_t)hash & (index->capacity - 1);
+    while (index->slots[slot] != 0) {
+        slot = (slot + 1) & (index->capacity - 1);
+    }
 
-    test_log_write(
-        "%s%s @ %d running '%s:%s':%s ", (options.colored) ? COLOR_DIM : "", test->file_name,
-        test->line, suit->name, test->name, (options.colored) ? COLOR_RESET : ""
-    );
+    index->slots[slot] = value + 1;
+}
 
-    if (suit->setup_function != NULL) {
-        suit->setup_function();
+/// Returns the first value for 'hash', for which 'matches' returns true, or UINT32_MAX
+static uint32_t test_hash_index_find(
+    const test_intern_HashIndex *index, uint64_t hash, bool (*matches)(uint32_t, const void *),
+    const void *key
+) {
+    if (index->slots == NULL) {
+        return UINT32_MAX;
     }
 
-    test_intern_Result result = test_intern_ResultOk;
-    test->function(&result);
-
-    if (suit->teardown_function != NULL) {
-        suit->teardown_function();
+    uint32_t slot = (uint32_t)hash & (index->capacity - 1);
+    while (index->slots[slot] != 0) {
+        if (matches(index->slots[slot] - 1, key)) {
+            return index->slots[slot] - 1;
+        }
+        slot = (slot + 1) & (index->capacity - 1);
     }
 
-    test_runner.tests_attempted++;
+    return UINT32_MAX;
+}
 
-    switch (result) {
-    case test_intern_ResultOk:
-        test_runner.tests_successful++;
-        break;
-    case test_intern_ResultPartiallyOk:
-        test_runner.tests_partially++;
-        break;
-    case test_intern_ResultSkipped:
-        test_runner.tests_skipped++;
-        break;
-    case test_intern_ResultFailed:
-        test_runner.tests_failed++;
-        break;
-    }
+static bool test_changes_match_cached_file(uint32_t value, const void *key) {
+    return strcmp(test_changes.cached_files[value].path, key) == 0;
+}
 
-    static const char *result_strings_colored[] = {
-        [test_intern_ResultOk] = COLOR_GREEN "ok" COLOR_RESET,
-        [test_intern_ResultPartiallyOk] = COLOR_YELLOW "partially ok" COLOR_RESET,
-        [test_intern_ResultSkipped] = COLOR_CYAN "skipped" COLOR_RESET,
-        [test_intern_ResultFailed] = COLOR_RED "failed" COLOR_RESET,
-    };
-    static const char *result_strings_blank[] = {
-        [test_intern_ResultOk] = "ok",
-        [test_intern_ResultPartiallyOk] = "partially ok",
-        [test_intern_ResultSkipped] = "skipped",
-        [test_intern_ResultFailed] = "failed",
-    };
+static bool test_changes_match_cached_case(uint32_t value, const void *key) {
+    return strcmp(test_changes.cached_cases[value].name, key) == 0;
+}
 
-    const char **result_strings = (options.colored) ? result_strings_colored : result_strings_blank;
-    test_log_write("%s\n", result_strings[result]);
+static bool test_changes_match_file(uint32_t value, const void *key) {
+    return strcmp(test_changes.files[value].path, key) == 0;
 }
 
-TEST_UNUSED
-static void test_runner_run_suit(const test_intern_Suit *suit_data) {
-    test_intern_assert(suit_data != NULL);
+static bool test_changes_match_case(uint32_t value, const void *key) {
+    return test_changes.cases[value] == key;
+}
 
-    for (uint32_t i = 0; i < suit_data->test_count; i++) {
-        test_runner_run_test(suit_data->test_list[i], suit_data->suit_data);
+/// Load the cache written by a previous run. A missing cache is not an error
+static bool test_changes_load(void) {
+    FILE *cache = fopen(test_changes.cache_path, "r");
+    if (cache == NULL) {
+        return errno == ENOENT;
     }
-}
 
-static test_intern_Suit *test_suit_find_by_name(const char *name) {
-    test_intern_assert(name != NULL);
+    char line[PATH_MAX + 128];
+    uint32_t line_number = 0;
+    while (fgets(line, sizeof(line), cache) != NULL) {
+        line_number++;
+        line[strcspn(line, "\n")] = '\0';
+
+        unsigned long long mtime_ns = 0;
+        unsigned long long size = 0;
+        unsigned long long hash = 0;
+        unsigned int status = 0;
+        int offset = 0;
+
+        if (line_number == 1) {
+            if (strncmp(line, "libtest-cache ", 14) != 0) {
+                goto invalid_line;
+            }
 
-    for (uint32_t i = 0; i < test_register.total_suits; i++) {
-        test_intern_Suit *suit_data = &test_register.suit_list[i];
+            // Caches of other versions are ignored, everything runs as if there was none
+            if (strcmp(line, "libtest-cache 2") != 0) {
+                break;
+            }
+        } else if (sscanf(line, "binary %llx", &hash) == 1) {
+            test_changes.has_cached_binary = true;
+            test_changes.cached_binary_hash = hash;
+        } else if (sscanf(line, "file %llu %llu %llx %n", &mtime_ns, &size, &hash, &offset) == 3 &&
+                   offset > 0) {
+            test_changes.cached_files = test_realloc(
+                test_changes.cached_files,
+                sizeof(test_intern_SourceFile[test_changes.cached_file_count + 1])
+            );
 
-        if (strcmp(suit_data->suit_data->name, name) == 0) {
-            return suit_data;
+            test_intern_SourceFile *file =
+                &test_changes.cached_files[test_changes.cached_file_count++];
+            memset(file, 0, sizeof(*file));
+            file->path = strdup(line + offset);
+            file->mtime_ns = mtime_ns;
+            file->size = size;
+            file->hash = hash;
+        } else if (sscanf(line, "case %u %n", &status, &offset) == 1 && offset > 0) {
+            test_changes.cached_cases = test_realloc(
+                test_changes.cached_cases,
+                sizeof(test_intern_CachedCase[test_changes.cached_case_count + 1])
+            );
+
+            test_intern_CachedCase *cached_case =
+                &test_changes.cached_cases[test_changes.cached_case_count++];
+            cached_case->name = strdup(line + offset);
+            cached_case->status = (uint8_t)status;
+        } else {
+            goto invalid_line;
         }
     }
+    fclose(cache);
 
-    return NULL;
-}
+    test_hash_index_init(&test_changes.cached_file_index, test_changes.cached_file_count);
+    for (uint32_t i = 0; i < test_changes.cached_file_count; i++) {
+        test_hash_index_insert(
+            &test_changes.cached_file_index, test_hash_string(test_changes.cached_files[i].path), i
+        );
+    }
 
-// TODO: Implement manual suit registration
-bool test_register_suit(
-    char *name, test_SetupFunction setup_func, test_TeardownFunction teardown_func
-) {
-    (void)name;
-    (void)setup_func;
-    (void)teardown_func;
+    test_hash_index_init(&test_changes.cached_case_index, test_changes.cached_case_count);
+    for (uint32_t i = 0; i < test_changes.cached_case_count; i++) {
+        test_hash_index_insert(
+            &test_changes.cached_case_index, test_hash_string(test_changes.cached_cases[i].name), i
+        );
+    }
 
+    return true;
+invalid_line:
+    fprintf(stderr, "[test]: Invalid cache entry: %s:%u\n", test_changes.cache_path, line_number);
+    fclose(cache);
     return false;
 }
 
-// TODO: Implement manual test registration
-bool test_register_case(char *suit_name, char *test_name, test_TestFunction func) {
-    (void)suit_name;
-    (void)test_name;
-    (void)func;
+static int test_changes_hash_build_id(struct dl_phdr_info *info, size_t size, void *data) {
+    (void)size;
+    uint64_t *hash = data;
 
-    return false;
-}
+    for (uint32_t i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr) *header = &info->dlpi_phdr[i];
+        if (header->p_type != PT_NOTE) {
+            continue;
+        }
 
-// Algorithm copied from:
-// http://yucoding.blogspot.com/2013/02/leetcode-question-123-wildcard-matching.html
-static bool test_wildcard_match(const char *text, const char *pattern) {
-    uint32_t text_offset = 0;
-    uint32_t pattern_offset = 0;
+        const uint8_t *note = (const uint8_t *)(info->dlpi_addr + header->p_vaddr);
+        const uint8_t *end = note + header->p_memsz;
+        while (note + sizeof(ElfW(Nhdr)) <= end) {
+            const ElfW(Nhdr) *note_header = (const ElfW(Nhdr) *)note;
+            const uint8_t *name = note + sizeof(ElfW(Nhdr));
+            const uint8_t *desc = name + ((note_header->n_namesz + 3) & ~3u);
+
+            if (note_header->n_type == NT_GNU_BUILD_ID && note_header->n_namesz == 4 &&
+                memcmp(name, "GNU", 4) == 0) {
+                *hash = test_hash_fnv1a(desc, note_header->n_descsz);
+                return 1;
+            }
+            note = desc + ((note_header->n_descsz + 3) & ~3u);
+        }
+    }
+
+    // Stop after the first object, which is the executable itself
+    return 1;
+}
+
+static int test_changes_hash_segments(struct dl_phdr_info *info, size_t size, void *data) {
+    (void)size;
+    uint64_t *hash = data;
+
+    // Code and constant data. Writable segments change while running
+    for (uint32_t i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr) *header = &info->dlpi_phdr[i];
+        if (header->p_type == PT_LOAD && (header->p_flags & PF_W) == 0) {
+            *hash = test_hash_fnv1a_update(
+                *hash, (const uint8_t *)(info->dlpi_addr + header->p_vaddr), header->p_filesz
+            );
+        }
+    }
+
+    return 1;
+}
+
+/// Hash of the test executable. Uses its build-id, or hashes its code and
+/// constant data if it was linked without one. Shared libraries are not included.
+static uint64_t test_changes_hash_binary(void) {
+    uint64_t hash = 0;
+    dl_iterate_phdr(test_changes_hash_build_id, &hash);
+
+    if (hash == 0) {
+        hash = TEST_HASH_FNV1A_INIT;
+        dl_iterate_phdr(test_changes_hash_segments, &hash);
+    }
+
+    return hash;
+}
+
+/// Compare a source file against its cached state. The content is only
+/// hashed, if its modification time or size changed.
+static void test_changes_check_file(test_intern_SourceFile *file) {
+    uint32_t cached_index = test_hash_index_find(
+        &test_changes.cached_file_index, test_hash_string(file->path),
+        test_changes_match_cached_file, file->path
+    );
+    const test_intern_SourceFile *cached =
+        (cached_index != UINT32_MAX) ? &test_changes.cached_files[cached_index] : NULL;
+
+    // Sources that can not be found (e.g. relative to a different directory) always run
+    struct stat info;
+    FILE *source = NULL;
+    if (stat(file->path, &info) != 0 || (source = fopen(file->path, "rb")) == NULL) {
+        file->is_changed = true;
+        return;
+    }
+
+    file->mtime_ns = (uint64_t)info.st_mtim.tv_sec * 1000000000ULL + (uint64_t)info.st_mtim.tv_nsec;
+    file->size = (uint64_t)info.st_size;
+
+    if (cached != NULL && cached->mtime_ns == file->mtime_ns && cached->size == file->size) {
+        fclose(source);
+        file->hash = cached->hash;
+        file->is_changed = false;
+        return;
+    }
+
+    uint8_t buffer[1 << 14];
+    size_t length = 0;
+    file->hash = TEST_HASH_FNV1A_INIT;
+    while ((length = fread(buffer, 1, sizeof(buffer), source)) > 0) {
+        file->hash = test_hash_fnv1a_update(file->hash, buffer, length);
+    }
+    fclose(source);
+
+    file->is_changed = cached == NULL || cached->hash != file->hash;
+}
+
+static uint32_t test_changes_add_file(const char *path) {
+    uint64_t hash = test_hash_string(path);
+    uint32_t index =
+        test_hash_index_find(&test_changes.file_index, hash, test_changes_match_file, path);
+    if (index != UINT32_MAX) {
+        return index;
+    }
+
+    index = test_changes.file_count++;
+    test_changes.files =
+        test_realloc(test_changes.files, sizeof(test_intern_SourceFile[test_changes.file_count]));
+    memset(&test_changes.files[index], 0, sizeof(test_intern_SourceFile));
+    test_changes.files[index].path = (char *)path;
+
+    test_changes_check_file(&test_changes.files[index]);
+    test_hash_index_insert(&test_changes.file_index, hash, index);
+
+    return index;
+}
+
+/// Select all test cases whose source file changed, that are new or did not pass last time
+static bool test_changes_prepare(void) {
+    if (!test_changes_load()) {
+        return false;
+    }
+
+    uint32_t case_count = test_register.total_tests;
+    test_changes.cases = test_calloc(case_count, sizeof(test_intern_TestCase *));
+    test_changes.suits = test_calloc(case_count, sizeof(test_intern_SuitData *));
+    test_changes.statuses = test_calloc(case_count, sizeof(uint8_t));
+    test_changes.is_selected = test_calloc(case_count, sizeof(bool));
+    test_hash_index_init(&test_changes.case_index, case_count);
+    // Every test case is defined in at most one source file, the index never fills up
+    test_hash_index_init(&test_changes.file_index, case_count);
+
+    char name_buffer[TEST_FILTER_SIZE_LIMIT * 2];
+    const char *last_file_name = NULL;
+    uint32_t file_index = 0;
+
+    for (uint32_t i = 0; i < test_register.total_suits; i++) {
+        test_intern_Suit *suit = &test_register.suit_list[i];
+
+        for (uint32_t j = 0; j < suit->test_count; j++) {
+            const test_intern_TestCase *test = suit->test_list[j];
+
+            // Adjacent test cases are usually defined in the same file
+            if (test->file_name != last_file_name) {
+                file_index = test_changes_add_file(test->file_name);
+                last_file_name = test->file_name;
+            }
+
+            snprintf(name_buffer, sizeof(name_buffer), "%s:%s", suit->suit_data->name, test->name);
+            uint32_t cached_index = test_hash_index_find(
+                &test_changes.cached_case_index, test_hash_string(name_buffer),
+                test_changes_match_cached_case, name_buffer
+            );
+            uint8_t status = (cached_index != UINT32_MAX)
+                                 ? test_changes.cached_cases[cached_index].status
+                                 : TEST_CHANGES_STATUS_UNKNOWN;
+
+            uint32_t index = test_changes.case_count++;
+            test_changes.cases[index] = test;
+            test_changes.suits[index] = suit->suit_data;
+            test_changes.statuses[index] = status;
+            test_changes.is_selected[index] =
+                test_changes.files[file_index].is_changed || status != test_intern_ResultOk;
+            test_changes.selected_count += test_changes.is_selected[index];
+            test_hash_index_insert(
+                &test_changes.case_index, test_hash_pointer(test), index
+            );
+        }
+    }
+
+    // Changes to code outside of the tracked sources (e.g. the code under test or headers)
+    // only show up in the binary. Which test cases are affected is unknown, so all of them run.
+    test_changes.binary_hash = test_changes_hash_binary();
+    bool has_changed_source = false;
+    for (uint32_t i = 0; i < test_changes.file_count; i++) {
+        has_changed_source |= test_changes.files[i].is_changed;
+    }
+
+    if (test_changes.has_cached_binary &&
+        test_changes.cached_binary_hash != test_changes.binary_hash && !has_changed_source) {
+        memset(test_changes.is_selected, true, test_changes.case_count);
+        test_changes.selected_count = test_changes.case_count;
+    }
+
+    // Selected test cases keep their selection until they ran, e.g. when excluded by a filter
+    for (uint32_t i = 0; i < test_changes.case_count; i++) {
+        if (test_changes.is_selected[i]) {
+            test_changes.statuses[i] = TEST_CHANGES_STATUS_UNKNOWN;
+        }
+    }
+
+    return true;
+}
+
+static uint32_t test_changes_find_case(const test_intern_TestCase *test) {
+    return test_hash_index_find(
+        &test_changes.case_index, test_hash_pointer(test), test_changes_match_case, test
+    );
+}
+
+static bool test_changes_is_selected(const test_intern_TestCase *test) {
+    uint32_t index = test_changes_find_case(test);
+    return index == UINT32_MAX || test_changes.is_selected[index];
+}
+
+static void test_changes_record(const test_intern_TestCase *test, test_intern_Result result) {
+    if (test_changes.cache_path == NULL) {
+        return;
+    }
+
+    uint32_t index = test_changes_find_case(test);
+    if (index != UINT32_MAX) {
+        test_changes.statuses[index] = (uint8_t)result;
+    }
+}
+
+/// Write the cache for the next run. Replaces the previous cache atomically
+static void test_changes_save(void) {
+    char temporary_path[PATH_MAX];
+    snprintf(temporary_path, sizeof(temporary_path), "%s.tmp", test_changes.cache_path);
+
+    FILE *cache = fopen(temporary_path, "w");
+    if (cache == NULL) {
+        fprintf(stderr, "[test]: Failed to write cache: %s: %s\n", temporary_path, strerror(errno));
+        return;
+    }
+
+    fprintf(cache, "libtest-cache 2\n");
+    fprintf(cache, "binary %016llx\n", (unsigned long long)test_changes.binary_hash);
+    for (uint32_t i = 0; i < test_changes.file_count; i++) {
+        const test_intern_SourceFile *file = &test_changes.files[i];
+        fprintf(
+            cache, "file %llu %llu %016llx %s\n", (unsigned long long)file->mtime_ns,
+            (unsigned long long)file->size, (unsigned long long)file->hash, file->path
+        );
+    }
+    for (uint32_t i = 0; i < test_changes.case_count; i++) {
+        fprintf(
+            cache, "case %u %s:%s\n", test_changes.statuses[i], test_changes.suits[i]->name,
+            test_changes.cases[i]->name
+        );
+    }
+
+    if (fclose(cache) != 0 || rename(temporary_path, test_changes.cache_path) != 0) {
+        fprintf(
+            stderr, "[test]: Failed to write cache: %s: %s\n", test_changes.cache_path,
+            strerror(errno)
+        );
+    }
+}
+
+static void test_changes_free(void) {
+    for (uint32_t i = 0; i < test_changes.cached_file_count; i++) {
+        free(test_changes.cached_files[i].path);
+    }
+    for (uint32_t i = 0; i < test_changes.cached_case_count; i++) {
+        free(test_changes.cached_cases[i].name);
+    }
+
+    free(test_changes.cached_files);
+    free(test_changes.cached_cases);
+    free(test_changes.cached_file_index.slots);
+    free(test_changes.cached_case_index.slots);
+    free(test_changes.files);
+    free(test_changes.file_index.slots);
+    free(test_changes.cases);
+    free(test_changes.suits);
+    free(test_changes.statuses);
+    free(test_changes.is_selected);
+    free(test_changes.case_index.slots);
+    memset(&test_changes, 0, sizeof(test_changes));
+}
+
+/* Scratch arena */
+// Filled into released scratch memory with '--scratch-poison'
+#define TEST_SCRATCH_POISON_BYTE 0xdb
+
+static struct {
+    // Used by synchronous test cases and fuzz targets
+    test_intern_ScratchArena arena;
+    // Maps suit data to its index in 'test_register.suit_list'. Built on first use
+    test_intern_HashIndex suit_index;
+} test_scratch = { 0 };
+
+void *test_scratch_alloc(size_t size) {
+    test_intern_ScratchArena *arena =
+        (test_async.current != NULL) ? &test_async.current->scratch : &test_scratch.arena;
+
+    if (arena->base == NULL) {
+        // Only reserves address space, pages are committed on first use
+        void *base = mmap(
+            NULL, TEST_SCRATCH_SIZE, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0
+        );
+        if (base == MAP_FAILED) {
+            perror("test: ");
+            abort();
+        }
+        arena->base = base;
+
+#ifdef TEST_HAS_ASAN
+        if (options.scratch_poison) {
+            __asan_poison_memory_region(arena->base, TEST_SCRATCH_SIZE);
+        }
+#endif
+    }
+
+    uint64_t offset = (arena->used + 15) & ~(uint64_t)15;
+    if (size > TEST_SCRATCH_SIZE - offset) {
+        fprintf(
+            stderr, "[test]: Scratch memory exhausted, %zu bytes requested with %llu in use\n",
+            size, (unsigned long long)arena->used
+        );
+        abort();
+    }
+
+    void *result = arena->base + offset;
+    arena->used = offset + size;
+
+#ifdef TEST_HAS_ASAN
+    if (options.scratch_poison) {
+        // The alignment padding stays poisoned and catches small overflows
+        __asan_unpoison_memory_region(result, size);
+    }
+#endif
+
+    return result;
+}
+
+static bool test_scratch_match_suit(uint32_t value, const void *key) {
+    return test_register.suit_list[value].suit_data == key;
+}
+
+/// Update the high-water mark of 'suit' with the scratch usage of one of its test cases
+static void test_scratch_record(const test_intern_SuitData *suit, uint64_t bytes) {
+    if (bytes == 0) {
+        return;
+    }
+
+    if (test_scratch.suit_index.slots == NULL) {
+        test_hash_index_init(&test_scratch.suit_index, test_register.total_suits);
+        for (uint32_t i = 0; i < test_register.total_suits; i++) {
+            test_hash_index_insert(
+                &test_scratch.suit_index, test_hash_pointer(test_register.suit_list[i].suit_data),
+                i
+            );
+        }
+    }
+
+    uint32_t index = test_hash_index_find(
+        &test_scratch.suit_index, test_hash_pointer(suit), test_scratch_match_suit, suit
+    );
+    if (index != UINT32_MAX && bytes > test_register.suit_list[index].scratch_high_water) {
+        test_register.suit_list[index].scratch_high_water = bytes;
+    }
+}
+
+/// Release all memory of 'arena'. Returns the amount of memory that was in use.
+/// With '--scratch-poison', released memory is poisoned to detect uses after the test case.
+static uint64_t test_scratch_release(test_intern_ScratchArena *arena) {
+    uint64_t used = arena->used;
+    if (used == 0) {
+        return 0;
+    }
+
+    if (options.scratch_poison) {
+#ifdef TEST_HAS_ASAN
+        __asan_poison_memory_region(arena->base, used);
+#else
+        memset(arena->base, TEST_SCRATCH_POISON_BYTE, used);
+#endif
+    }
+
+    arena->used = 0;
+    return used;
+}
+
+static void test_scratch_free(void) {
+    if (test_scratch.arena.base != NULL) {
+        munmap(test_scratch.arena.base, TEST_SCRATCH_SIZE);
+    }
+    for (uint32_t i = 0; i < TEST_ASYNC_INFLIGHT_LIMIT; i++) {
+        if (test_async.slots[i].scratch.base != NULL) {
+            munmap(test_async.slots[i].scratch.base, TEST_SCRATCH_SIZE);
+        }
+    }
+
+    memset(&test_scratch, 0, sizeof(test_scratch));
+}
+
+/* Noise control */
+typedef struct {
+    struct rusage usage;
+    uint64_t migrations;
+    int cpu;
+} test_intern_NoiseSnapshot;
+
+static struct {
+    // Counts the CPU migrations of the calling thread. Opened per process, because
+    // forked workers would otherwise read the counter of their parent.
+    int migrations_fd;
+    pid_t migrations_pid;
+} test_noise = { -1, 0 };
+
+static uint64_t test_noise_read_migrations(void) {
+    if (test_noise.migrations_pid != getpid()) {
+        if (test_noise.migrations_fd >= 0) {
+            close(test_noise.migrations_fd);
+        }
+
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_SOFTWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_SW_CPU_MIGRATIONS;
+
+        // Fails without permissions (see perf_event_paranoid), sched_getcpu() is used instead
+        test_noise.migrations_fd =
+            (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+        test_noise.migrations_pid = getpid();
+    }
+
+    uint64_t count = 0;
+    if (test_noise.migrations_fd >= 0 &&
+        read(test_noise.migrations_fd, &count, sizeof(count)) != sizeof(count)) {
+        count = 0;
+    }
+
+    return count;
+}
+
+static void test_noise_begin(test_intern_NoiseSnapshot *snapshot) {
+    snapshot->migrations = test_noise_read_migrations();
+    snapshot->cpu = sched_getcpu();
+    getrusage(RUSAGE_THREAD, &snapshot->usage);
+}
+
+static void
+test_noise_end(const test_intern_NoiseSnapshot *snapshot, test_intern_RunSample *sample) {
+    struct rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    int cpu = sched_getcpu();
+
+    sample->voluntary_switches = (uint64_t)(usage.ru_nvcsw - snapshot->usage.ru_nvcsw);
+    sample->involuntary_switches = (uint64_t)(usage.ru_nivcsw - snapshot->usage.ru_nivcsw);
+
+    if (test_noise.migrations_fd >= 0) {
+        sample->migrations = test_noise_read_migrations() - snapshot->migrations;
+    } else {
+        // Only detects migrations, that did not return to the same CPU
+        sample->migrations = (cpu != snapshot->cpu);
+    }
+}
+
+static void test_noise_free(void) {
+    if (test_noise.migrations_fd >= 0) {
+        close(test_noise.migrations_fd);
+    }
+
+    test_noise.migrations_fd = -1;
+    test_noise.migrations_pid = 0;
+}
+
+/// Touch the stack, so that its pages are already mapped (and locked) when running tests
+__attribute__((noinline)) static void test_prefault_stack(void) {
+    volatile uint8_t stack[TEST_PREFAULT_STACK_SIZE];
+    for (size_t i = 0; i < sizeof(stack); i += 4096) {
+        stack[i] = 0;
+    }
+}
+
+/// Lock all current and future memory and fault in the stack and heap up front,
+/// so that tests are not interrupted by page faults
+static bool test_lock_memory(void) {
+#ifdef MCL_ONFAULT
+    // Pages are locked once used, instead of populating every mapping (e.g. the scratch arena)
+    int flags = MCL_CURRENT | MCL_FUTURE | MCL_ONFAULT;
+#else
+    int flags = MCL_CURRENT | MCL_FUTURE;
+#endif
+    if (mlockall(flags) != 0) {
+        fprintf(stderr, "[test]: Failed to lock memory: %s\n", strerror(errno));
+        return false;
+    }
+
+    // Keep freed memory in the heap, instead of returning it to the kernel
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+
+    uint8_t *heap = test_realloc(NULL, TEST_PREFAULT_HEAP_SIZE);
+    for (size_t i = 0; i < TEST_PREFAULT_HEAP_SIZE; i += 4096) {
+        ((volatile uint8_t *)heap)[i] = 0;
+    }
+    free(heap);
+
+    test_prefault_stack();
+    return true;
+}
+
+/// Apply '--cpus', '--nice' and '--mlock' to the runner
+static bool test_isolate_process(void) {
+    if (options.cpu_count > 0 && sched_setaffinity(0, sizeof(cpu_set_t), &options.cpu_set) != 0) {
+        fprintf(stderr, "[test]: Failed to set CPU affinity: %s\n", strerror(errno));
+        return false;
+    }
+
+    if (options.raw.nice_value != NULL && setpriority(PRIO_PROCESS, 0, options.nice) != 0) {
+        fprintf(stderr, "[test]: Failed to set priority: %s\n", strerror(errno));
+        return false;
+    }
+
+    if (options.mlock && !test_lock_memory()) {
+        return false;
+    }
+
+    return true;
+}
+
+/// CPU of the worker 'worker_index'. Workers are pinned to the CPUs of '--cpus' round robin
+static uint16_t test_worker_cpu(uint32_t worker_index) {
+    return options.cpu_list[worker_index % options.cpu_count];
+}
+
+/// Pin a forked worker to a single CPU of '--cpus'. Memory locks are not inherited by
+/// forked processes and must be applied again.
+static bool test_isolate_worker(uint32_t worker_index) {
+    if (options.cpu_count > 0) {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(test_worker_cpu(worker_index), &cpu_set);
+
+        if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+            fprintf(stderr, "[test]: Failed to set CPU affinity: %s\n", strerror(errno));
+            return false;
+        }
+    }
+
+    if (options.mlock && !test_lock_memory()) {
+        return false;
+    }
+
+    return true;
+}
+
+/* Test runner */
+// Avoids depending on libm
+static double test_sqrt(double value) {
+    if (value <= 0) {
+        return 0;
+    }
+
+    double result = (value > 1) ? value : 1;
+    for (uint32_t i = 0; i < 64; i++) {
+        double next = 0.5 * (result + value / result);
+        if (next >= result) {
+            break;
+        }
+        result = next;
+    }
+
+    return result;
+}
+
+/// Classify the runs of a repeated test case as "stable", "flaky", "failing" or "skipped"
+static const char *test_repeat_status(const test_intern_RepeatStats *stats) {
+    uint32_t failed = stats->results[test_intern_ResultFailed];
+    uint32_t runs = stats->runs + stats->crashed_runs;
+
+    if (failed > 0) {
+        return (failed < runs) ? "flaky" : "failing";
+    }
+    return (runs > 0) ? "stable" : "skipped";
+}
+
+/// The "worst" result of all runs of a repeated test case
+static test_intern_Result test_repeat_result(const test_intern_RepeatStats *stats) {
+    for (int32_t i = test_intern_ResultCount - 1; i >= 0; i--) {
+        if (stats->results[i] > 0) {
+            return (test_intern_Result)i;
+        }
+    }
+
+    // Test cases, that never ran because all workers exited early, are skipped
+    return (stats->runs + stats->crashed_runs > 0) ? test_intern_ResultOk
+                                                   : test_intern_ResultSkipped;
+}
+
+static void test_runner_report_repeats(void) {
+    test_log_write(
+        "\n%-40s %-8s %8s %8s %7s %11s %11s %11s %11s\n", "repeated case", "status", "runs",
+        "failed", "rate", "mean (us)", "stddev (us)", "min (us)", "max (us)"
+    );
+
+    char name_buffer[TEST_FILTER_SIZE_LIMIT];
+    for (uint32_t i = 0; i < test_runner.repeat_count; i++) {
+        const test_intern_RepeatStats *stats = &test_runner.repeat_stats[i];
+        uint32_t failed = stats->results[test_intern_ResultFailed];
+        uint32_t runs = stats->runs + stats->crashed_runs;
+        double stddev = (stats->runs > 1) ? test_sqrt(stats->m2_ns / (stats->runs - 1)) : 0;
+
+        snprintf(
+            name_buffer, sizeof(name_buffer), "%s:%s", test_runner.repeat_suits[i]->name,
+            test_runner.repeat_tests[i]->name
+        );
+        test_log_write(
+            "%-40s %-8s %8u %8u %6.2f%% %11.2f %11.2f %11.2f %11.2f\n", name_buffer,
+            test_repeat_status(stats), runs, failed, (runs > 0) ? failed * 100.0 / runs : 0,
+            stats->mean_ns / 1e3, stddev / 1e3, (double)stats->min_ns / 1e3,
+            (double)stats->max_ns / 1e3
+        );
+    }
+}
+
+static void test_runner_report_scratch(void) {
+    bool has_header = false;
+
+    for (uint32_t i = 0; i < test_register.total_suits; i++) {
+        const test_intern_Suit *suit = &test_register.suit_list[i];
+        if (suit->scratch_high_water == 0) {
+            continue;
+        }
+
+        if (!has_header) {
+            test_log_write("\n%-40s %16s\n", "suit", "scratch (bytes)");
+            has_header = true;
+        }
+        test_log_write(
+            "%-40s %16llu\n", suit->suit_data->name, (unsigned long long)suit->scratch_high_water
+        );
+    }
+}
+
+static void test_runner_report(void) {
+    uint32_t failed_percent = (test_runner.tests_failed > 0)
+                                  ? (test_runner.tests_failed * 100 / test_register.total_tests)
+                                  : 0;
+    uint32_t skipped_percent = (test_runner.tests_skipped > 0)
+                                   ? (test_runner.tests_skipped * 100 / test_register.total_tests)
+                                   : 0;
+    uint32_t success_percent =
+        (test_runner.tests_successful) > 0
+            ? (test_runner.tests_successful * 100 / test_register.total_tests)
+            : 0;
+    uint32_t partial_percent = (test_runner.tests_partially > 0)
+                                   ? (test_runner.tests_partially * 100 / test_register.total_tests)
+                                   : 0;
+
+    test_log_write(
+        "attempted to run %d out of %d tests\n", test_runner.tests_attempted,
+        test_register.total_tests
+    );
+    test_log_write("successful: %u - %3u%%\n", test_runner.tests_successful, success_percent);
+    test_log_write("failed    : %u - %3u%%\n", test_runner.tests_failed, failed_percent);
+    test_log_write("partially : %u - %3u%%\n", test_runner.tests_partially, partial_percent);
+    test_log_write("skipped   : %u - %3u%%\n", test_runner.tests_skipped, skipped_percent);
+
+    if (test_runner.repeat_count > 0) {
+        test_runner_report_repeats();
+    }
+
+    test_runner_report_scratch();
+}
+
+static void
+test_runner_print_test(const test_intern_TestCase *test, const test_intern_SuitData *suit) {
+    test_log_write(
+        "%s%s @ %d running '%s:%s':%s ", (options.colored) ? COLOR_DIM : "", test->file_name,
+        test->line, suit->name, test->name, (options.colored) ? COLOR_RESET : ""
+    );
+}
+
+static void test_runner_count_result(test_intern_Result result) {
+    test_runner.tests_attempted++;
+
+    switch (result) {
+    case test_intern_ResultOk:
+        test_runner.tests_successful++;
+        break;
+    case test_intern_ResultPartiallyOk:
+        test_runner.tests_partially++;
+        break;
+    case test_intern_ResultSkipped:
+        test_runner.tests_skipped++;
+        break;
+    case test_intern_ResultFailed:
+        test_runner.tests_failed++;
+        break;
+    }
+}
+
+/// Append a record to the '--results' file, if any
+static void test_results_write(
+    const char *file_name, uint32_t line, const char *suit_name, const char *case_name,
+    test_intern_Result result, const test_intern_RepeatStats *stats
+) {
+    if (test_results.fd < 0) {
+        return;
+    }
+
+    const char *strings[] = { file_name, suit_name, case_name, stats->failure.buffer };
+    uint16_t lengths[4] = { 0 };
+    uint32_t size = sizeof(test_intern_ResultRecord);
+    for (uint32_t i = 0; i < 4; i++) {
+        size_t length = strlen(strings[i]);
+        lengths[i] = (uint16_t)((length < UINT16_MAX) ? length : UINT16_MAX - 1);
+        size += lengths[i] + 1u;
+    }
+    size = (size + 7) & ~7u;
+
+    if (size > test_results.buffer_size) {
+        test_results.buffer = test_realloc(test_results.buffer, size);
+        test_results.buffer_size = size;
+    }
+    memset(test_results.buffer, 0, size);
+
+    test_intern_ResultRecord record = { 0 };
+    record.size = size;
+    record.line = line;
+    record.runs = stats->runs + stats->crashed_runs;
+    record.failures = stats->results[test_intern_ResultFailed];
+    record.duration_ns = (uint64_t)(stats->mean_ns * stats->runs);
+    record.duration_max_ns = stats->max_ns;
+    record.file_length = lengths[0];
+    record.suit_length = lengths[1];
+    record.case_length = lengths[2];
+    record.message_length = lengths[3];
+    record.status = (uint8_t)result;
+
+    uint32_t offset = sizeof(record);
+    for (uint32_t i = 0; i < 4; i++) {
+        if (i == 3 && lengths[i] > 0) {
+            record.message_offset = offset;
+        }
+
+        memcpy(test_results.buffer + offset, strings[i], lengths[i]);
+        offset += lengths[i] + 1u;
+    }
+    memcpy(test_results.buffer, &record, sizeof(record));
+
+    // Appending with a single write keeps records of concurrent writers intact
+    uint32_t written = 0;
+    while (written < size) {
+        ssize_t result = write(test_results.fd, test_results.buffer + written, size - written);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            fprintf(stderr, "[test]: Failed to write results: %s\n", strerror(errno));
+            return;
+        }
+        written += (uint32_t)result;
+    }
+}
+
+static void test_runner_record_result(
+    const test_intern_TestCase *test, const test_intern_SuitData *suit,
+    const test_intern_RepeatStats *stats, test_intern_Result result
+) {
+    test_runner_count_result(result);
+    test_results_write(test->file_name, test->line, suit->name, test->name, result, stats);
+    test_changes_record(test, result);
+    test_scratch_record(suit, stats->scratch_bytes);
+
+    static const char *result_strings_colored[] = {
+        [test_intern_ResultOk] = COLOR_GREEN "ok" COLOR_RESET,
+        [test_intern_ResultPartiallyOk] = COLOR_YELLOW "partially ok" COLOR_RESET,
+        [test_intern_ResultSkipped] = COLOR_CYAN "skipped" COLOR_RESET,
+        [test_intern_ResultFailed] = COLOR_RED "failed" COLOR_RESET,
+    };
+    static const char *result_strings_blank[] = {
+        [test_intern_ResultOk] = "ok",
+        [test_intern_ResultPartiallyOk] = "partially ok",
+        [test_intern_ResultSkipped] = "skipped",
+        [test_intern_ResultFailed] = "failed",
+    };
+
+    const char **result_strings = (options.colored) ? result_strings_colored : result_strings_blank;
+    if (options.noise && stats->runs > 0) {
+        // Repeated test cases report the mean duration and the noise of all runs
+        test_log_write(
+            "%s (%.2f us, %llu voluntary and %llu involuntary context switches, %llu migrations)\n",
+            result_strings[result], stats->mean_ns / 1e3,
+            (unsigned long long)stats->voluntary_switches,
+            (unsigned long long)stats->involuntary_switches, (unsigned long long)stats->migrations
+        );
+    } else {
+        test_log_write("%s\n", result_strings[result]);
+    }
+}
+
+static void test_repeat_update(
+    test_intern_RepeatStats *stats, test_intern_Result result, const test_intern_RunSample *sample
+) {
+    uint64_t duration_ns = sample->duration_ns;
+    double delta = (double)duration_ns - stats->mean_ns;
+
+    stats->runs++;
+    stats->mean_ns += delta / stats->runs;
+    stats->m2_ns += delta * ((double)duration_ns - stats->mean_ns);
+
+    if (stats->runs == 1 || duration_ns < stats->min_ns) {
+        stats->min_ns = duration_ns;
+    }
+    if (duration_ns > stats->max_ns) {
+        stats->max_ns = duration_ns;
+    }
+    if (sample->scratch_bytes > stats->scratch_bytes) {
+        stats->scratch_bytes = sample->scratch_bytes;
+    }
+
+    stats->voluntary_switches += sample->voluntary_switches;
+    stats->involuntary_switches += sample->involuntary_switches;
+    stats->migrations += sample->migrations;
+
+    if (result == test_intern_ResultFailed) {
+        // Read by other workers with '--until-fail'
+        __atomic_fetch_add(&stats->results[result], 1, __ATOMIC_RELAXED);
+    } else {
+        stats->results[result]++;
+    }
+}
+
+/// Execute a single test case, including the suits setup and teardown.
+/// Only the test function itself is included in the duration and noise of 'sample'.
+/// The scratch memory used by the test case is released afterwards.
+static test_intern_Result test_runner_execute(
+    const test_intern_TestCase *test, const test_intern_SuitData *suit,
+    test_intern_RunSample *sample
+) {
+    test_intern_assert(test->function != NULL);
+
+    memset(sample, 0, sizeof(*sample));
+
+    if (suit->setup_function != NULL) {
+        suit->setup_function();
+    }
+
+    test_intern_NoiseSnapshot noise;
+    if (options.noise) {
+        test_noise_begin(&noise);
+    }
+
+    test_intern_Result result = test_intern_ResultOk;
+    uint64_t start_time = test_time_now_ns();
+    test->function(&result);
+    sample->duration_ns = test_time_now_ns() - start_time;
+
+    if (options.noise) {
+        test_noise_end(&noise, sample);
+    }
+
+    if (suit->teardown_function != NULL) {
+        suit->teardown_function();
+    }
+
+    sample->scratch_bytes = test_scratch_release(&test_scratch.arena);
+
+    return result;
+}
+
+static void
+test_runner_run_test(const test_intern_TestCase *test, const test_intern_SuitData *suit) {
+    test_intern_assert(test != NULL);
+    test_intern_assert(suit != NULL);
+
+    test_runner_print_test(test, suit);
+
+    test_intern_RepeatStats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    // The log output is additionally captured, so that it can be added to the results
+    if (test_results.fd >= 0) {
+        log_data.capture = &stats.failure;
+        log_data.is_capture_streamed = true;
+    }
+    test_intern_RunSample sample;
+    test_intern_Result result = test_runner_execute(test, suit, &sample);
+    log_data.capture = NULL;
+    log_data.is_capture_streamed = false;
+
+    test_repeat_update(&stats, result, &sample);
+    test_runner_record_result(test, suit, &stats, result);
+}
+
+/* Repeated test runner */
+static void
+test_repeat_queue(const test_intern_TestCase *test, const test_intern_SuitData *suit) {
+    uint32_t count = test_runner.repeat_count + 1;
+    test_runner.repeat_tests =
+        test_realloc(test_runner.repeat_tests, sizeof(test_intern_TestCase * [count]));
+    test_runner.repeat_suits =
+        test_realloc(test_runner.repeat_suits, sizeof(test_intern_SuitData * [count]));
+
+    test_runner.repeat_tests[test_runner.repeat_count] = test;
+    test_runner.repeat_suits[test_runner.repeat_count] = suit;
+    test_runner.repeat_count = count;
+}
+
+/// Combine the statistics of two disjoint sets of runs, see:
+/// https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance#Parallel_algorithm
+static void
+test_repeat_merge(test_intern_RepeatStats *target, const test_intern_RepeatStats *source) {
+    if (target->runs == 0) {
+        target->mean_ns = source->mean_ns;
+        target->m2_ns = source->m2_ns;
+        target->min_ns = source->min_ns;
+        target->max_ns = source->max_ns;
+    } else if (source->runs > 0) {
+        double runs = (double)target->runs + source->runs;
+        double delta = source->mean_ns - target->mean_ns;
+
+        target->mean_ns += delta * source->runs / runs;
+        target->m2_ns += source->m2_ns + delta * delta * target->runs * source->runs / runs;
+        target->min_ns = (source->min_ns < target->min_ns) ? source->min_ns : target->min_ns;
+        target->max_ns = (source->max_ns > target->max_ns) ? source->max_ns : target->max_ns;
+    }
+
+    target->scratch_bytes = (source->scratch_bytes > target->scratch_bytes)
+                                ? source->scratch_bytes
+                                : target->scratch_bytes;
+    target->voluntary_switches += source->voluntary_switches;
+    target->involuntary_switches += source->involuntary_switches;
+    target->migrations += source->migrations;
+    target->runs += source->runs;
+    target->crashed_runs += source->crashed_runs;
+
+    for (uint32_t i = 0; i < test_intern_ResultCount; i++) {
+        target->results[i] += source->results[i];
+    }
+
+    if (target->failure.length == 0) {
+        target->failure = source->failure;
+    }
+}
+
+/// Runs this workers share of the repetitions of every queued test case.
+/// 'all_stats' holds the statistics of all workers, one row of 'repeat_count' entries each.
+/// 'current_case' is set to the index of the running test case, or UINT32_MAX once done.
+static void test_repeat_worker(
+    uint32_t worker_index, test_intern_RepeatStats *all_stats, uint32_t *current_case
+) {
+    uint32_t case_count = test_runner.repeat_count;
+    test_intern_RepeatStats *worker_stats = &all_stats[worker_index * case_count];
+
+    uint32_t runs = options.repeat / options.jobs + (worker_index < options.repeat % options.jobs);
+    test_intern_LogCapture capture;
+
+    for (uint32_t i = 0; i < case_count; i++) {
+        __atomic_store_n(current_case, i, __ATOMIC_RELAXED);
+
+        for (uint32_t run = 0; run < runs; run++) {
+            if (options.until_fail) {
+                bool has_failed = false;
+                for (uint32_t worker = 0; worker < options.jobs && !has_failed; worker++) {
+                    has_failed = __atomic_load_n(
+                        &all_stats[worker * case_count + i].results[test_intern_ResultFailed],
+                        __ATOMIC_RELAXED
+                    ) > 0;
+                }
+
+                if (has_failed) {
+                    break;
+                }
+            }
+
+            capture.length = 0;
+            capture.buffer[0] = '\0';
+            log_data.capture = &capture;
+
+            test_intern_RunSample sample;
+            test_intern_Result result = test_runner_execute(
+                test_runner.repeat_tests[i], test_runner.repeat_suits[i], &sample
+            );
+            log_data.capture = NULL;
+
+            test_intern_RepeatStats *stats = &worker_stats[i];
+            if (result == test_intern_ResultFailed && stats->failure.length == 0) {
+                stats->failure = capture;
+            }
+            test_repeat_update(stats, result, &sample);
+        }
+    }
+
+    __atomic_store_n(current_case, UINT32_MAX, __ATOMIC_RELAXED);
+}
+
+/// Count the run, that was interrupted by the abnormal exit of a worker, as failed.
+/// It was not measured, so it is left out of the timing statistics.
+static void test_repeat_fail_run(test_intern_RepeatStats *stats, const char *format, ...) {
+    stats->crashed_runs++;
+    stats->results[test_intern_ResultFailed]++;
+
+    if (stats->failure.length == 0) {
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(stats->failure.buffer, sizeof(stats->failure.buffer), format, args);
+        va_end(args);
+
+        stats->failure.length = (length > 0) ? (uint32_t)length : 0;
+    }
+}
+
+/// Run all queued test cases 'options.repeat' times, spread across 'options.jobs' workers.
+static void test_repeat_run_all(void) {
+    uint32_t case_count = test_runner.repeat_count;
+    if (case_count == 0) {
+        return;
+    }
+
+    test_runner.repeat_stats = test_calloc(case_count, sizeof(test_intern_RepeatStats));
+
+    if (options.jobs == 1) {
+        uint32_t current_case = 0;
+        test_repeat_worker(0, test_runner.repeat_stats, &current_case);
+    } else {
+        // Worker statistics are kept in shared memory, so that the results
+        // of forked workers are visible to the parent process. It is followed
+        // by the index of the test case every worker is running.
+        size_t stats_size = sizeof(test_intern_RepeatStats) * case_count * options.jobs +
+                            sizeof(uint32_t) * options.jobs;
+        test_intern_RepeatStats *all_stats =
+            mmap(NULL, stats_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (all_stats == MAP_FAILED) {
+            perror("test: ");
+            abort();
+        }
+
+        uint32_t *current_cases = (uint32_t *)&all_stats[case_count * options.jobs];
+        for (uint32_t i = 0; i < options.jobs; i++) {
+            current_cases[i] = UINT32_MAX;
+        }
+
+        fflush(options.output_stream);
+
+        pid_t *workers = test_calloc(options.jobs, sizeof(pid_t));
+        for (uint32_t i = 0; i < options.jobs; i++) {
+            workers[i] = fork();
+
+            if (workers[i] == 0) {
+                if (!test_isolate_worker(i)) {
+                    for (uint32_t j = 0; j < case_count; j++) {
+                        test_repeat_fail_run(
+                            &all_stats[i * case_count + j], "failed to isolate worker %u: ", i
+                        );
+                    }
+                    _exit(1);
+                }
+                test_repeat_worker(i, all_stats, &current_cases[i]);
+
+                fflush(options.output_stream);
+                _exit(0);
+            } else if (workers[i] < 0) {
+                perror("test: ");
+            }
+        }
+
+        for (uint32_t i = 0; i < options.jobs; i++) {
+            int status = 0;
+            if (workers[i] <= 0 || waitpid(workers[i], &status, 0) < 0) {
+                continue;
+            }
+
+            // The remaining runs of the worker are lost
+            uint32_t current_case = current_cases[i];
+            test_intern_RepeatStats *stats =
+                (current_case != UINT32_MAX) ? &all_stats[i * case_count + current_case] : NULL;
+
+            if (WIFSIGNALED(status)) {
+                test_log_write("worker %u terminated by signal %d\n", i, WTERMSIG(status));
+                if (stats != NULL) {
+                    test_repeat_fail_run(
+                        stats, "worker %u terminated by signal %d: ", i, WTERMSIG(status)
+                    );
+                }
+            } else if (WIFEXITED(status) && WEXITSTATUS(status) != 0) {
+                test_log_write("worker %u exited with status %d\n", i, WEXITSTATUS(status));
+                if (stats != NULL) {
+                    test_repeat_fail_run(
+                        stats, "worker %u exited with status %d: ", i, WEXITSTATUS(status)
+                    );
+                }
+            }
+        }
+        free(workers);
+
+        for (uint32_t worker = 0; worker < options.jobs; worker++) {
+            for (uint32_t i = 0; i < case_count; i++) {
+                test_repeat_merge(
+                    &test_runner.repeat_stats[i], &all_stats[worker * case_count + i]
+                );
+            }
+        }
+
+        munmap(all_stats, stats_size);
+    }
+
+    for (uint32_t i = 0; i < case_count; i++) {
+        const test_intern_RepeatStats *stats = &test_runner.repeat_stats[i];
+        uint32_t runs = stats->runs + stats->crashed_runs;
+        test_intern_Result result = test_repeat_result(stats);
+
+        test_runner_print_test(test_runner.repeat_tests[i], test_runner.repeat_suits[i]);
+        test_log_write(
+            "%u/%u runs passed, %s", runs - stats->results[test_intern_ResultFailed], runs,
+            stats->failure.buffer
+        );
+        test_runner_record_result(
+            test_runner.repeat_tests[i], test_runner.repeat_suits[i], stats, result
+        );
+    }
+}
+
+TEST_UNUSED
+static void test_runner_run_suit(const test_intern_Suit *suit_data) {
+    test_intern_assert(suit_data != NULL);
+
+    for (uint32_t i = 0; i < suit_data->test_count; i++) {
+        test_runner_run_test(suit_data->test_list[i], suit_data->suit_data);
+    }
+}
+
+/* Asynchronous test runner */
+bool test_async_watch(int fd, uint32_t events, test_AsyncCallback callback, void *user_data) {
+    test_intern_assert(callback != NULL);
+
+    test_intern_AsyncSlot *slot = test_async.current;
+    if (slot == NULL) {
+        test_log_write("test_async_watch() used outside of an asynchronous test case: ");
+        return false;
+    }
+
+    test_intern_AsyncWatch *watch = NULL;
+    uint32_t watch_index = 0;
+    for (; watch_index < TEST_ASYNC_WATCH_LIMIT; watch_index++) {
+        if (test_async.watches[watch_index].slot == NULL) {
+            watch = &test_async.watches[watch_index];
+            break;
+        }
+    }
+
+    if (watch == NULL) {
+        test_log_write("reached watch limit: ");
+        return false;
+    }
+
+    watch->generation++;
+
+    struct epoll_event event = { 0 };
+    event.events = events;
+    event.data.u64 = ((uint64_t)watch->generation << 32) | watch_index;
+    if (epoll_ctl(test_async.epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        test_log_write("failed to watch fd %d: %s: ", fd, strerror(errno));
+        return false;
+    }
+
+    watch->fd = fd;
+    watch->slot = slot;
+    watch->callback = callback;
+    watch->user_data = user_data;
+    slot->watch_count++;
+
+    return true;
+}
+
+static void test_async_remove_watch(test_intern_AsyncWatch *watch) {
+    // Fails if the file descriptor was already closed, which is fine
+    epoll_ctl(test_async.epoll_fd, EPOLL_CTL_DEL, watch->fd, NULL);
+
+    watch->slot->watch_count--;
+    watch->slot = NULL;
+}
+
+void test_async_unwatch(int fd) {
+    test_intern_AsyncSlot *slot = test_async.current;
+    if (slot == NULL) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < TEST_ASYNC_WATCH_LIMIT; i++) {
+        test_intern_AsyncWatch *watch = &test_async.watches[i];
+        if (watch->slot == slot && watch->fd == fd) {
+            test_async_remove_watch(watch);
+            return;
+        }
+    }
+}
+
+void test_async_done(void) {
+    if (test_async.current != NULL) {
+        test_async.current->is_done = true;
+    }
+}
+
+static void test_async_finish(test_intern_AsyncSlot *slot) {
+    for (uint32_t i = 0; i < TEST_ASYNC_WATCH_LIMIT && slot->watch_count > 0; i++) {
+        if (test_async.watches[i].slot == slot) {
+            test_async_remove_watch(&test_async.watches[i]);
+        }
+    }
+
+    test_async.current = slot;
+    log_data.capture = &slot->log;
+    if (slot->suit->teardown_function != NULL) {
+        slot->suit->teardown_function();
+    }
+    log_data.capture = NULL;
+    test_async.current = NULL;
+
+    slot->is_active = false;
+    test_async.active_count--;
+
+    test_intern_RunSample sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.duration_ns = test_time_now_ns() - slot->start_time;
+    sample.scratch_bytes = test_scratch_release(&slot->scratch);
+
+    test_intern_RepeatStats stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.failure = slot->log;
+    test_repeat_update(&stats, slot->result, &sample);
+
+    test_runner_print_test(slot->test, slot->suit);
+    test_log_write("%s", slot->log.buffer);
+    test_runner_record_result(slot->test, slot->suit, &stats, slot->result);
+}
+
+/// Finish the slot, if there is nothing left to wait for
+static void test_async_check(test_intern_AsyncSlot *slot) {
+    if (slot->is_done || slot->watch_count == 0 || slot->result == test_intern_ResultFailed) {
+        test_async_finish(slot);
+    }
+}
+
+static void test_async_start(const test_intern_AsyncPending *pending) {
+    test_intern_AsyncSlot *slot = NULL;
+    for (uint32_t i = 0; i < TEST_ASYNC_INFLIGHT_LIMIT; i++) {
+        if (!test_async.slots[i].is_active) {
+            slot = &test_async.slots[i];
+            break;
+        }
+    }
+    test_intern_assert(slot != NULL);
+
+    // The scratch memory of the slot is reused
+    test_intern_ScratchArena scratch = slot->scratch;
+    memset(slot, 0, sizeof(*slot));
+    slot->scratch = scratch;
+    slot->is_active = true;
+    slot->test = pending->test;
+    slot->suit = pending->suit;
+    slot->result = test_intern_ResultOk;
+    slot->start_time = test_time_now_ns();
+    slot->deadline = (pending->test->timeout_ms > 0)
+                         ? test_time_now_ns() + pending->test->timeout_ms * 1000000ULL
+                         : UINT64_MAX;
+    test_async.active_count++;
+
+    test_async.current = slot;
+    log_data.capture = &slot->log;
+    if (slot->suit->setup_function != NULL) {
+        slot->suit->setup_function();
+    }
+    slot->test->async_function(&slot->result);
+    log_data.capture = NULL;
+    test_async.current = NULL;
+
+    test_async_check(slot);
+}
+
+static void test_async_dispatch(const struct epoll_event *event) {
+    uint32_t watch_index = (uint32_t)(event->data.u64 & 0xffffffff);
+    uint32_t generation = (uint32_t)(event->data.u64 >> 32);
+
+    test_intern_AsyncWatch *watch = &test_async.watches[watch_index];
+    if (watch->slot == NULL || watch->generation != generation) {
+        // The watch was removed by an earlier event of the same batch
+        return;
+    }
+
+    test_intern_AsyncSlot *slot = watch->slot;
+
+    test_async.current = slot;
+    log_data.capture = &slot->log;
+    watch->callback(&slot->result, watch->fd, event->events, watch->user_data);
+    log_data.capture = NULL;
+    test_async.current = NULL;
+
+    test_async_check(slot);
+}
+
+/// Run all queued asynchronous test cases on a single epoll loop
+static void test_async_run_all(void) {
+    if (test_async.pending_count == 0) {
+        return;
+    }
+
+    test_async.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (test_async.epoll_fd < 0) {
+        perror("test: ");
+        abort();
+    }
+
+    struct epoll_event events[TEST_ASYNC_INFLIGHT_LIMIT];
+    uint32_t next_pending = 0;
+
+    while (next_pending < test_async.pending_count || test_async.active_count > 0) {
+        while (test_async.active_count < TEST_ASYNC_INFLIGHT_LIMIT &&
+               next_pending < test_async.pending_count) {
+            test_async_start(&test_async.pending[next_pending++]);
+        }
+
+        if (test_async.active_count == 0) {
+            continue;
+        }
+
+        uint64_t now = test_time_now_ns();
+        uint64_t next_deadline = UINT64_MAX;
+        for (uint32_t i = 0; i < TEST_ASYNC_INFLIGHT_LIMIT; i++) {
+            if (test_async.slots[i].is_active && test_async.slots[i].deadline < next_deadline) {
+                next_deadline = test_async.slots[i].deadline;
+            }
+        }
+
+        int timeout = -1;
+        if (next_deadline != UINT64_MAX) {
+            uint64_t remaining_ms =
+                (next_deadline > now) ? (next_deadline - now + 999999) / 1000000 : 0;
+            timeout = (remaining_ms > INT32_MAX) ? INT32_MAX : (int)remaining_ms;
+        }
+
+        int event_count =
+            epoll_wait(test_async.epoll_fd, events, TEST_ASYNC_INFLIGHT_LIMIT, timeout);
+        if (event_count < 0 && errno != EINTR) {
+            perror("test: ");
+            abort();
+        }
+
+        for (int i = 0; i < event_count; i++) {
+            test_async_dispatch(&events[i]);
+        }
+
+        now = test_time_now_ns();
+        for (uint32_t i = 0; i < TEST_ASYNC_INFLIGHT_LIMIT; i++) {
+            test_intern_AsyncSlot *slot = &test_async.slots[i];
+            if (slot->is_active && slot->deadline <= now) {
+                log_data.capture = &slot->log;
+                test_log_write("timed out after %u ms: ", slot->test->timeout_ms);
+                log_data.capture = NULL;
+
+                slot->result = test_intern_ResultFailed;
+                test_async_finish(slot);
+            }
+        }
+    }
+
+    close(test_async.epoll_fd);
+
+    free(test_async.pending);
+    test_async.pending = NULL;
+    test_async.pending_count = 0;
+}
+
+static void
+test_async_queue(const test_intern_TestCase *test, const test_intern_SuitData *suit) {
+    test_async.pending = test_realloc(
+        test_async.pending, sizeof(test_intern_AsyncPending[test_async.pending_count + 1])
+    );
+
+    test_async.pending[test_async.pending_count].test = test;
+    test_async.pending[test_async.pending_count].suit = suit;
+    test_async.pending_count++;
+}
+
+
+static test_intern_Suit *test_suit_find_by_name(const char *name) {
+    test_intern_assert(name != NULL);
+
+    for (uint32_t i = 0; i < test_register.total_suits; i++) {
+        test_intern_Suit *suit_data = &test_register.suit_list[i];
+
+        if (strcmp(suit_data->suit_data->name, name) == 0) {
+            return suit_data;
+        }
+    }
+
+    return NULL;
+}
+
+// TODO: Implement manual suit registration
+bool test_register_suit(
+    char *name, test_SetupFunction setup_func, test_TeardownFunction teardown_func
+) {
+    (void)name;
+    (void)setup_func;
+    (void)teardown_func;
+
+    return false;
+}
+
+// TODO: Implement manual test registration
+bool test_register_case(char *suit_name, char *test_name, test_TestFunction func) {
+    (void)suit_name;
+    (void)test_name;
+    (void)func;
+
+    return false;
+}
+
+// Algorithm copied from:
+// http://yucoding.blogspot.com/2013/02/leetcode-question-123-wildcard-matching.html
+static bool test_wildcard_match(const char *text, const char *pattern) {
+    uint32_t text_offset = 0;
+    uint32_t pattern_offset = 0;
 
     int32_t bt_text_offset = -1;
     int32_t bt_pattern_offset = -1;
@@ -457,31 +2424,614 @@ static bool test_wildcard_match(const char *text, const char *pattern) {
         pattern_offset++;
     }
 
-    return pattern_offset == strlen(pattern);
-}
+    return pattern_offset == strlen(pattern);
+}
+
+static bool test_filter_case(const char *suit_name, const char *test_name) {
+    static char name_buffer[TEST_FILTER_SIZE_LIMIT] = { 0 };
+    memset(name_buffer, 0, sizeof(name_buffer));
+
+    if (strlen(suit_name) + strlen(test_name) + 1 > TEST_FILTER_SIZE_LIMIT) {
+        return false;
+    }
+
+    memcpy(name_buffer, suit_name, strlen(suit_name));
+    name_buffer[strlen(suit_name)] = ':';
+    memcpy(name_buffer + strlen(suit_name) + 1, test_name, strlen(test_name));
+
+    for (uint32_t i = 0; i < options.filter_pattern_count; i++) {
+        if (test_wildcard_match(name_buffer, options.filter_pattern[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Fuzzer */
+static inline uint64_t test_fuzz_random(void) {
+    // xorshift64*
+    test_fuzzer.random_state ^= test_fuzzer.random_state >> 12;
+    test_fuzzer.random_state ^= test_fuzzer.random_state << 25;
+    test_fuzzer.random_state ^= test_fuzzer.random_state >> 27;
+
+    return test_fuzzer.random_state * 0x2545f4914f6cdd1dULL;
+}
+
+static inline uint32_t test_fuzz_random_below(uint32_t limit) {
+    return (limit > 0) ? (uint32_t)(test_fuzz_random() % limit) : 0;
+}
+
+static inline uint32_t test_fuzz_min(uint32_t a, uint32_t b) { return (a < b) ? a : b; }
+
+static uint32_t test_fuzz_insert(
+    uint8_t *data, uint32_t size, uint32_t max_size, const uint8_t *bytes, uint32_t count
+) {
+    count = test_fuzz_min(count, max_size - size);
+
+    uint32_t offset = test_fuzz_random_below(size + 1);
+    memmove(data + offset + count, data + offset, size - offset);
+    memcpy(data + offset, bytes, count);
+
+    return size + count;
+}
+
+static void
+test_fuzz_overwrite(uint8_t *data, uint32_t size, const uint8_t *bytes, uint32_t count) {
+    count = test_fuzz_min(count, size);
+
+    uint32_t offset = test_fuzz_random_below(size - count + 1);
+    memcpy(data + offset, bytes, count);
+}
+
+/// Apply a single random mutation to 'data' in place. Returns the new size.
+static uint32_t test_fuzz_mutate(uint8_t *data, uint32_t size, uint32_t max_size) {
+    static const int32_t interesting_values[] = {
+        0, 1, -1, 16, 32, 64, 100, 127, -128, 255, 256, 512, 1000, 1024, 4096,
+        32767, -32768, 65535, 65536, INT32_MAX, INT32_MIN,
+    };
+
+    uint8_t bytes[16];
+
+    if (size == 0) {
+        bytes[0] = (uint8_t)test_fuzz_random();
+        return test_fuzz_insert(data, size, max_size, bytes, 1);
+    }
+
+    switch (test_fuzz_random_below(8)) {
+    case 0: // Flip a single bit
+        data[test_fuzz_random_below(size)] ^= (uint8_t)(1u << test_fuzz_random_below(8));
+        break;
+    case 1: // Replace a byte with a random value
+        data[test_fuzz_random_below(size)] = (uint8_t)test_fuzz_random();
+        break;
+    case 2: { // Add or subtract a small value
+        uint32_t offset = test_fuzz_random_below(size);
+        uint8_t delta = (uint8_t)(1 + test_fuzz_random_below(16));
+        data[offset] = (test_fuzz_random() & 1) ? (uint8_t)(data[offset] + delta)
+                                                : (uint8_t)(data[offset] - delta);
+    } break;
+    case 3: { // Overwrite with an interesting 8, 16 or 32 bit value
+        int32_t value = interesting_values[test_fuzz_random_below(
+            sizeof(interesting_values) / sizeof(interesting_values[0])
+        )];
+        memcpy(bytes, &value, sizeof(value));
+        test_fuzz_overwrite(data, size, bytes, 1u << test_fuzz_random_below(3));
+    } break;
+    case 4: { // Erase a range of bytes
+        uint32_t count = 1 + test_fuzz_random_below(test_fuzz_min(size, 16));
+        uint32_t offset = test_fuzz_random_below(size - count + 1);
+        memmove(data + offset, data + offset + count, size - offset - count);
+        size -= count;
+    } break;
+    case 5: { // Insert random bytes
+        uint32_t count = 1 + test_fuzz_random_below(sizeof(bytes));
+        for (uint32_t i = 0; i < count; i++) {
+            bytes[i] = (uint8_t)test_fuzz_random();
+        }
+        size = test_fuzz_insert(data, size, max_size, bytes, count);
+    } break;
+    case 6: { // Splice in a chunk of another corpus entry
+        if (test_fuzzer.corpus_count == 0) {
+            break;
+        }
+
+        const test_intern_FuzzInput *entry =
+            &test_fuzzer.corpus[test_fuzz_random_below(test_fuzzer.corpus_count)];
+        if (entry->size == 0) {
+            break;
+        }
+
+        uint32_t count = 1 + test_fuzz_random_below(test_fuzz_min(entry->size, 64));
+        const uint8_t *chunk = entry->data + test_fuzz_random_below(entry->size - count + 1);
+        if (test_fuzz_random() & 1) {
+            size = test_fuzz_insert(data, size, max_size, chunk, count);
+        } else {
+            test_fuzz_overwrite(data, size, chunk, count);
+        }
+    } break;
+    case 7: { // Insert or overwrite with a dictionary token
+        if (test_fuzzer.dict_count == 0) {
+            break;
+        }
+
+        const test_intern_FuzzInput *token =
+            &test_fuzzer.dict[test_fuzz_random_below(test_fuzzer.dict_count)];
+        if (test_fuzz_random() & 1) {
+            size = test_fuzz_insert(data, size, max_size, token->data, token->size);
+        } else {
+            test_fuzz_overwrite(data, size, token->data, token->size);
+        }
+    } break;
+    }
+
+    return size;
+}
+
+static void test_fuzz_write_stderr(const char *message) {
+    size_t length = 0;
+    while (message[length] != '\0') {
+        length++;
+    }
+
+    if (write(STDERR_FILENO, message, length) < 0) {
+        return;
+    }
+}
+
+/// Write 'data' to 'crash-<suit>-<name>-<hash>' inside the current working directory.
+/// Async signal safe.
+static bool test_fuzz_save_crash(const uint8_t *data, uint32_t size) {
+    static const char hex_digits[] = "0123456789abcdef";
+
+    uint32_t length = 0;
+    while (test_fuzzer.crash_name[length] != '\0') {
+        test_fuzzer.crash_path[length] = test_fuzzer.crash_name[length];
+        length++;
+    }
+
+    uint64_t hash = test_hash_fnv1a(data, size);
+    test_fuzzer.crash_path[length++] = '-';
+    for (int32_t shift = 60; shift >= 0; shift -= 4) {
+        test_fuzzer.crash_path[length++] = hex_digits[(hash >> shift) & 0xf];
+    }
+    test_fuzzer.crash_path[length] = '\0';
+
+    int fd = open(test_fuzzer.crash_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        test_fuzz_write_stderr("[test]: Failed to save crashing input\n");
+        return false;
+    }
+
+    uint32_t offset = 0;
+    while (offset < size) {
+        ssize_t written = write(fd, data + offset, size - offset);
+        if (written <= 0) {
+            break;
+        }
+        offset += (uint32_t)written;
+    }
+    close(fd);
+
+    return offset == size;
+}
+
+static void test_fuzz_signal_handler(int signal_number) {
+    if (test_fuzzer.current_data != NULL &&
+        test_fuzz_save_crash(test_fuzzer.current_data, test_fuzzer.current_size)) {
+        test_fuzz_write_stderr("[test]: Saved crashing input to ");
+        test_fuzz_write_stderr(test_fuzzer.crash_path);
+        test_fuzz_write_stderr("\n");
+    }
+
+    // The handler was installed with SA_RESETHAND. Let the default action take over
+    if (signal_number != 0) {
+        raise(signal_number);
+    }
+}
+
+#ifdef TEST_HAS_ASAN
+// AddressSanitizer exits without raising a signal
+static void test_fuzz_death_callback(void) { test_fuzz_signal_handler(0); }
+#endif
+
+static bool test_fuzz_read_input(const char *path, test_intern_FuzzInput *input) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "[test]: Failed to open fuzzing input: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    // Inputs exceeding the size limit are truncated
+    input->data = test_realloc(NULL, TEST_FUZZ_INPUT_SIZE_LIMIT);
+    input->size = (uint32_t)fread(input->data, 1, TEST_FUZZ_INPUT_SIZE_LIMIT, file);
+    fclose(file);
+
+    return true;
+}
+
+static bool test_fuzz_load_corpus(const char *directory) {
+    DIR *corpus_dir = opendir(directory);
+    if (corpus_dir == NULL) {
+        fprintf(
+            stderr, "[test]: Failed to open corpus directory: %s: %s\n", directory, strerror(errno)
+        );
+        return false;
+    }
+
+    char path[PATH_MAX];
+    struct dirent *entry = NULL;
+    while ((entry = readdir(corpus_dir)) != NULL) {
+        struct stat info;
+        snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+        if (stat(path, &info) != 0 || !S_ISREG(info.st_mode)) {
+            continue;
+        }
+
+        test_fuzzer.corpus = test_realloc(
+            test_fuzzer.corpus, sizeof(test_intern_FuzzInput[test_fuzzer.corpus_count + 1])
+        );
+        if (!test_fuzz_read_input(path, &test_fuzzer.corpus[test_fuzzer.corpus_count])) {
+            closedir(corpus_dir);
+            return false;
+        }
+        test_fuzzer.corpus_count++;
+    }
+    closedir(corpus_dir);
+
+    // Without any seeds, start out with a single empty input
+    if (test_fuzzer.corpus_count == 0) {
+        test_fuzzer.corpus = test_calloc(1, sizeof(test_intern_FuzzInput));
+        test_fuzzer.corpus_count = 1;
+    }
+
+    return true;
+}
+
+/// Load a dictionary in the format used by AFL and libFuzzer. Every non empty line,
+/// that is not a comment, contains a single quoted token: 'name="value"'
+/// The value supports the escape sequences '\\', '\"' and '\xNN'.
+static bool test_fuzz_load_dict(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "[test]: Failed to open dictionary: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    char line[TEST_FUZZ_DICT_LINE_LIMIT + 2];
+    uint32_t line_number = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line_number++;
+
+        // fgets() splits longer lines, the last line may end without a newline
+        if (strchr(line, '\n') == NULL) {
+            int next = fgetc(file);
+            if (next != EOF) {
+                fprintf(
+                    stderr, "[test]: Dictionary line exceeds %u characters: %s:%u\n",
+                    TEST_FUZZ_DICT_LINE_LIMIT, path, line_number
+                );
+                fclose(file);
+                return false;
+            }
+        }
+
+        char *start = line;
+        while (isspace((unsigned char)*start)) {
+            start++;
+        }
+        if (*start == '\0' || *start == '#') {
+            continue;
+        }
+
+        char *value = strchr(start, '"');
+        char *value_end = strrchr(start, '"');
+        if (value == NULL || value == value_end) {
+            goto invalid_line;
+        }
+
+        if (test_fuzzer.dict_count >= TEST_FUZZ_DICT_COUNT_LIMIT) {
+            fprintf(stderr, "[test]: Reached dictionary limit\n");
+            fclose(file);
+            return false;
+        }
+
+        test_intern_FuzzInput *token = &test_fuzzer.dict[test_fuzzer.dict_count];
+        token->data = test_realloc(NULL, (uintptr_t)(value_end - value));
+        token->size = 0;
+
+        for (char *iter = value + 1; iter < value_end; iter++) {
+            if (*iter != '\\') {
+                token->data[token->size++] = (uint8_t)*iter;
+            } else if (iter + 1 < value_end && (iter[1] == '\\' || iter[1] == '"')) {
+                token->data[token->size++] = (uint8_t)iter[1];
+                iter += 1;
+            } else if (iter + 3 < value_end && iter[1] == 'x' && isxdigit((unsigned char)iter[2]) &&
+                       isxdigit((unsigned char)iter[3])) {
+                char digits[3] = { iter[2], iter[3], '\0' };
+                token->data[token->size++] = (uint8_t)strtoul(digits, NULL, 16);
+                iter += 3;
+            } else {
+                free(token->data);
+                goto invalid_line;
+            }
+        }
+
+        if (token->size == 0) {
+            free(token->data);
+            continue;
+        }
+
+        test_fuzzer.dict_count++;
+    }
+
+    fclose(file);
+    return true;
+invalid_line:
+    fprintf(stderr, "[test]: Invalid dictionary entry: %s:%u\n", path, line_number);
+    fclose(file);
+    return false;
+}
+
+static bool test_fuzz_execute(
+    const test_intern_FuzzCase *fuzz, const test_intern_SuitData *suit, const uint8_t *data,
+    uint32_t size
+) {
+    test_fuzzer.current_size = size;
+    test_fuzzer.current_data = data;
+
+    if (suit->setup_function != NULL) {
+        suit->setup_function();
+    }
+
+    test_intern_Result result = test_intern_ResultOk;
+    fuzz->function(&result, data, size);
+
+    if (suit->teardown_function != NULL) {
+        suit->teardown_function();
+    }
+
+    test_scratch_release(&test_scratch.arena);
+    test_fuzzer.current_data = NULL;
+
+    return result != test_intern_ResultFailed;
+}
+
+/// Replay the corpus, then execute 'options.fuzz_runs' mutated inputs.
+/// Stops at the first failing input.
+static void
+test_fuzz_run_target(const test_intern_FuzzCase *fuzz, const test_intern_SuitData *suit) {
+    test_intern_assert(fuzz != NULL);
+    test_intern_assert(suit != NULL);
+
+    test_log_write(
+        "%s%s @ %d fuzzing '%s:%s':%s ", (options.colored) ? COLOR_DIM : "", fuzz->file_name,
+        fuzz->line, suit->name, fuzz->name, (options.colored) ? COLOR_RESET : ""
+    );
+
+    snprintf(
+        test_fuzzer.crash_name, sizeof(test_fuzzer.crash_name), "crash-%s-%s", suit->name,
+        fuzz->name
+    );
+
+    uint64_t execs = 0;
+    bool crashed = false;
+    uint64_t total_runs = (uint64_t)test_fuzzer.corpus_count + options.fuzz_runs;
+    uint64_t start_time = test_time_now_ns();
+
+    for (uint64_t run = 0; run < total_runs && !crashed; run++) {
+        bool is_replay = run < test_fuzzer.corpus_count;
+        const test_intern_FuzzInput *seed =
+            &test_fuzzer.corpus[is_replay ? run : test_fuzz_random_below(test_fuzzer.corpus_count)];
+
+        uint32_t size = seed->size;
+        if (size > 0) {
+            memcpy(test_fuzzer.mutation_buffer, seed->data, size);
+        }
+
+        if (!is_replay) {
+            uint32_t mutation_count = 1 + test_fuzz_random_below(4);
+            for (uint32_t i = 0; i < mutation_count; i++) {
+                size = test_fuzz_mutate(
+                    test_fuzzer.mutation_buffer, size, TEST_FUZZ_INPUT_SIZE_LIMIT
+                );
+            }
+        }
+
+        uint8_t *input = test_fuzzer.input_buffer + (TEST_FUZZ_INPUT_SIZE_LIMIT - size);
+        if (size > 0) {
+            memcpy(input, test_fuzzer.mutation_buffer, size);
+        }
+
+        crashed = !test_fuzz_execute(fuzz, suit, input, size);
+        execs++;
+
+        if (crashed && !test_fuzz_save_crash(input, size)) {
+            test_fuzzer.crash_path[0] = '\0';
+        }
+    }
+
+    double elapsed = (double)(test_time_now_ns() - start_time) / 1e9;
+    double execs_per_second = (elapsed > 0) ? (double)execs / elapsed : 0;
+
+    test_intern_FuzzStats *stats = &test_fuzzer.stats[test_fuzzer.worker_index];
+    stats->execs += execs;
+    stats->targets++;
+
+    if (test_results.fd >= 0) {
+        test_intern_RepeatStats result_stats;
+        memset(&result_stats, 0, sizeof(result_stats));
+        result_stats.runs = (execs < UINT32_MAX) ? (uint32_t)execs : UINT32_MAX;
+        result_stats.results[test_intern_ResultFailed] = crashed ? 1 : 0;
+        result_stats.mean_ns = (execs > 0) ? elapsed * 1e9 / (double)result_stats.runs : 0;
+        if (crashed) {
+            result_stats.failure.length = (uint32_t)snprintf(
+                result_stats.failure.buffer, TEST_LOG_BUFFER_SIZE, "input saved to '%s'",
+                test_fuzzer.crash_path
+            );
+        }
+
+        test_results_write(
+            fuzz->file_name, fuzz->line, suit->name, fuzz->name,
+            crashed ? test_intern_ResultFailed : test_intern_ResultOk, &result_stats
+        );
+    }
+
+    if (crashed) {
+        stats->crashes++;
+        test_log_write(
+            "%s after %llu execs, input saved to '%s'\n",
+            (options.colored) ? COLOR_RED "failed" COLOR_RESET : "failed",
+            (unsigned long long)execs, test_fuzzer.crash_path
+        );
+    } else {
+        test_log_write(
+            "%s (%llu execs, %.0f execs/sec)\n",
+            (options.colored) ? COLOR_GREEN "ok" COLOR_RESET : "ok", (unsigned long long)execs,
+            execs_per_second
+        );
+    }
+}
+
+static void test_fuzz_worker(void) {
+    static const int crash_signals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+    struct sigaction previous_actions[sizeof(crash_signals) / sizeof(crash_signals[0])];
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = test_fuzz_signal_handler;
+    action.sa_flags = SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+
+    for (uint32_t i = 0; i < sizeof(crash_signals) / sizeof(crash_signals[0]); i++) {
+        sigaction(crash_signals[i], &action, &previous_actions[i]);
+    }
+
+#ifdef TEST_HAS_ASAN
+    __sanitizer_set_death_callback(test_fuzz_death_callback);
+#endif
+
+    for (uint32_t i = 0; i < test_register.total_suits; i++) {
+        test_intern_Suit *suit = &test_register.suit_list[i];
+
+        for (uint32_t i = 0; i < suit->fuzz_count; i++) {
+            if (options.filter_pattern_count == 0 ||
+                test_filter_case(suit->suit_data->name, suit->fuzz_list[i]->name)) {
+                test_fuzz_run_target(suit->fuzz_list[i], suit->suit_data);
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < sizeof(crash_signals) / sizeof(crash_signals[0]); i++) {
+        sigaction(crash_signals[i], &previous_actions[i], NULL);
+    }
+
+#ifdef TEST_HAS_ASAN
+    __sanitizer_set_death_callback(NULL);
+#endif
+}
+
+static void test_fuzz_all(void) {
+    uint64_t seed = test_time_now_ns() ^ ((uint64_t)getpid() << 32);
+
+    // Worker statistics are kept in shared memory, so that the results
+    // of forked workers are visible to the parent process
+    size_t stats_size = sizeof(test_intern_FuzzStats[options.jobs]);
+    test_fuzzer.stats =
+        mmap(NULL, stats_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (test_fuzzer.stats == MAP_FAILED) {
+        perror("test: ");
+        abort();
+    }
+    memset(test_fuzzer.stats, 0, stats_size);
+
+    test_fuzzer.mutation_buffer = test_realloc(NULL, TEST_FUZZ_INPUT_SIZE_LIMIT);
+    test_fuzzer.input_buffer = test_realloc(NULL, TEST_FUZZ_INPUT_SIZE_LIMIT);
+
+    uint32_t workers_crashed = 0;
+    uint64_t start_time = test_time_now_ns();
+
+    if (options.jobs == 1) {
+        test_fuzzer.random_state = seed | 1;
+        test_fuzz_worker();
+    } else {
+        fflush(options.output_stream);
+
+        pid_t *workers = test_calloc(options.jobs, sizeof(pid_t));
+        for (uint32_t i = 0; i < options.jobs; i++) {
+            workers[i] = fork();
+
+            if (workers[i] == 0) {
+                if (!test_isolate_worker(i)) {
+                    _exit(1);
+                }
+                test_fuzzer.worker_index = i;
+                test_fuzzer.random_state = (seed ^ ((i + 1) * 0x9e3779b97f4a7c15ULL)) | 1;
+                test_fuzz_worker();
+
+                fflush(options.output_stream);
+                _exit(0);
+            } else if (workers[i] < 0) {
+                perror("test: ");
+            }
+        }
+
+        for (uint32_t i = 0; i < options.jobs; i++) {
+            int status = 0;
+            if (workers[i] <= 0 || waitpid(workers[i], &status, 0) < 0) {
+                continue;
+            }
 
-static bool test_filter_case(const char *suit_name, const char *test_name) {
-    static char name_buffer[TEST_FILTER_SIZE_LIMIT] = { 0 };
-    memset(name_buffer, 0, sizeof(name_buffer));
+            if (WIFSIGNALED(status)) {
+                test_log_write("worker %u terminated by signal %d\n", i, WTERMSIG(status));
+                workers_crashed++;
+            } else if (WIFEXITED(status) && WEXITSTATUS(status) != 0) {
+                test_log_write("worker %u exited with status %d\n", i, WEXITSTATUS(status));
+                workers_crashed++;
+            }
+        }
 
-    if (strlen(suit_name) + strlen(test_name) + 1 > TEST_FILTER_SIZE_LIMIT) {
-        return false;
+        free(workers);
     }
 
-    memcpy(name_buffer, suit_name, strlen(suit_name));
-    name_buffer[strlen(suit_name)] = ':';
-    memcpy(name_buffer + strlen(suit_name) + 1, test_name, strlen(test_name));
-
-    for (uint32_t i = 0; i < options.filter_pattern_count; i++) {
-        if (test_wildcard_match(name_buffer, options.filter_pattern[i])) {
-            return true;
+    double elapsed = (double)(test_time_now_ns() - start_time) / 1e9;
+    uint64_t total_execs = 0;
+    uint32_t total_targets = 0;
+    uint32_t total_crashes = workers_crashed;
+    for (uint32_t i = 0; i < options.jobs; i++) {
+        total_execs += test_fuzzer.stats[i].execs;
+        total_crashes += test_fuzzer.stats[i].crashes;
+        if (test_fuzzer.stats[i].targets > total_targets) {
+            total_targets = test_fuzzer.stats[i].targets;
         }
     }
 
-    return false;
+    test_log_write(
+        "fuzzed %u targets using %u workers in %.2fs\n", total_targets, options.jobs, elapsed
+    );
+    test_log_write(
+        "execs  : %llu - %.0f/sec\n", (unsigned long long)total_execs,
+        (elapsed > 0) ? (double)total_execs / elapsed : 0
+    );
+    test_log_write("crashes: %u\n", total_crashes);
+
+    munmap(test_fuzzer.stats, stats_size);
+    test_fuzzer.stats = NULL;
 }
 
 void test_run_all(void) {
+    if (options.fuzz_corpus != NULL) {
+        test_fuzz_all();
+        return;
+    }
+
+    if (test_changes.cache_path != NULL) {
+        test_log_write(
+            "selected %u out of %u tests changed since the last run\n", test_changes.selected_count,
+            test_changes.case_count
+        );
+    }
+
     for (uint32_t i = 0; i < test_register.total_suits; i++) {
         test_intern_Suit *suit = &test_register.suit_list[i];
 
@@ -491,7 +3041,15 @@ void test_run_all(void) {
                 is_match = test_filter_case(suit->suit_data->name, suit->test_list[i]->name);
             }
 
-            if (is_match) {
+            if (is_match && test_changes.cache_path != NULL) {
+                is_match = test_changes_is_selected(suit->test_list[i]);
+            }
+
+            if (is_match && suit->test_list[i]->async_function != NULL) {
+                test_async_queue(suit->test_list[i], suit->suit_data);
+            } else if (is_match && options.repeat > 0) {
+                test_repeat_queue(suit->test_list[i], suit->suit_data);
+            } else if (is_match) {
                 test_runner_run_test(suit->test_list[i], suit->suit_data);
             } else {
                 test_runner.tests_skipped++;
@@ -499,7 +3057,13 @@ void test_run_all(void) {
         }
     }
 
+    test_repeat_run_all();
+    test_async_run_all();
     test_runner_report();
+
+    if (test_changes.cache_path != NULL) {
+        test_changes_save();
+    }
 }
 
 static void test_list_all(void) {
@@ -514,7 +3078,237 @@ static void test_list_all(void) {
                 test_log_write("    - %s:%s\n", suit->suit_data->name, suit->test_list[i]->name);
             }
         }
+
+        for (uint32_t i = 0; i < suit->fuzz_count; i++) {
+            if (options.filter_pattern_count == 0 ||
+                test_filter_case(suit->suit_data->name, suit->fuzz_list[i]->name)) {
+                test_log_write(
+                    "    - %s:%s (fuzz)\n", suit->suit_data->name, suit->fuzz_list[i]->name
+                );
+            }
+        }
+    }
+}
+
+/* Results */
+static bool test_results_open(const char *path) {
+    test_results.fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (test_results.fd < 0) {
+        fprintf(stderr, "[test]: Failed to open results file: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    // Multiple processes may share a single results file. Only the first one writes the header
+    flock(test_results.fd, LOCK_EX);
+
+    struct stat info;
+    bool is_valid = fstat(test_results.fd, &info) == 0;
+    if (is_valid && info.st_size == 0) {
+        test_intern_ResultsHeader header = { 0 };
+        memcpy(header.magic, TEST_RESULTS_MAGIC, sizeof(header.magic));
+        header.version = TEST_RESULTS_VERSION;
+        header.header_size = sizeof(header);
+        header.record_size = sizeof(test_intern_ResultRecord);
+
+        is_valid = write(test_results.fd, &header, sizeof(header)) == sizeof(header);
+    }
+
+    flock(test_results.fd, LOCK_UN);
+
+    if (!is_valid) {
+        fprintf(stderr, "[test]: Failed to write results file: %s: %s\n", path, strerror(errno));
+        close(test_results.fd);
+        test_results.fd = -1;
+    }
+
+    return is_valid;
+}
+
+static void test_results_print_json_string(const char *text) {
+    char buffer[256];
+    uint32_t length = 0;
+
+    buffer[length++] = '"';
+    for (const char *iter = text; *iter != '\0'; iter++) {
+        // Leave room for the longest escape sequence, the closing quote and the terminator
+        if (length + 8 >= sizeof(buffer)) {
+            buffer[length] = '\0';
+            test_log_write("%s", buffer);
+            length = 0;
+        }
+
+        unsigned char current_char = (unsigned char)*iter;
+        if (current_char == '"' || current_char == '\\') {
+            buffer[length++] = '\\';
+            buffer[length++] = (char)current_char;
+        } else if (current_char < 0x20) {
+            length += (uint32_t)snprintf(buffer + length, 7, "\\u%04x", current_char);
+        } else {
+            buffer[length++] = (char)current_char;
+        }
+    }
+    buffer[length++] = '"';
+    buffer[length] = '\0';
+
+    test_log_write("%s", buffer);
+}
+
+static void test_results_print_record(
+    const test_intern_ResultRecord *record, const char *file_name, const char *suit_name,
+    const char *case_name, const char *message
+) {
+    static const char *status_strings[] = {
+        [test_intern_ResultOk] = "ok",
+        [test_intern_ResultPartiallyOk] = "partially ok",
+        [test_intern_ResultSkipped] = "skipped",
+        [test_intern_ResultFailed] = "failed",
+    };
+
+    if (options.merge_format == test_intern_MergeText) {
+        test_log_write(
+            "%s @ %u '%s:%s': %s (%u runs, %u failed, %.2f ms) ", file_name, record->line,
+            suit_name, case_name, status_strings[record->status], record->runs, record->failures,
+            (double)record->duration_ns / 1e6
+        );
+        test_log_write("%s\n", message);
+    } else if (options.merge_format == test_intern_MergeJson) {
+        test_log_write(
+            (test_results.record_count == 0) ? "[\n  {\"file\": " : ",\n  {\"file\": "
+        );
+        test_results_print_json_string(file_name);
+        test_log_write(", \"line\": %u, \"suit\": ", record->line);
+        test_results_print_json_string(suit_name);
+        test_log_write(", \"case\": ");
+        test_results_print_json_string(case_name);
+        test_log_write(
+            ", \"status\": \"%s\", \"runs\": %u, \"failures\": %u, \"duration_ns\": %llu, "
+            "\"duration_max_ns\": %llu, \"message\": ",
+            status_strings[record->status], record->runs, record->failures,
+            (unsigned long long)record->duration_ns, (unsigned long long)record->duration_max_ns
+        );
+        test_results_print_json_string(message);
+        test_log_write("}");
+    }
+}
+
+/// Validate all records of a single memory mapped results file and add them to the runner.
+/// Files found in a directory are skipped, if they are not results files at all.
+static bool test_results_merge_file(const char *path, bool is_in_directory) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0) {
+        fprintf(stderr, "[test]: Failed to open results file: %s: %s\n", path, strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        return false;
+    }
+
+    size_t size = (size_t)info.st_size;
+    if (size < sizeof(test_intern_ResultsHeader)) {
+        close(fd);
+        if (is_in_directory) {
+            return true;
+        }
+        fprintf(stderr, "[test]: Not a results file: %s\n", path);
+        return false;
+    }
+
+    const uint8_t *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "[test]: Failed to map results file: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    test_intern_ResultsHeader header;
+    memcpy(&header, data, sizeof(header));
+    bool is_results_file = memcmp(header.magic, TEST_RESULTS_MAGIC, sizeof(header.magic)) == 0;
+    if (!is_results_file && is_in_directory) {
+        munmap((void *)data, size);
+        return true;
+    }
+
+    if (!is_results_file ||
+        header.version != TEST_RESULTS_VERSION || header.header_size < sizeof(header) ||
+        header.record_size < sizeof(test_intern_ResultRecord) || header.header_size > size) {
+        fprintf(stderr, "[test]: Not a supported results file: %s\n", path);
+        munmap((void *)data, size);
+        return false;
+    }
+
+    size_t offset = header.header_size;
+    while (offset + sizeof(test_intern_ResultRecord) <= size) {
+        test_intern_ResultRecord record;
+        memcpy(&record, data + offset, sizeof(record));
+
+        const char *file_name = (const char *)data + offset + header.record_size;
+        const char *suit_name = file_name + record.file_length + 1;
+        const char *case_name = suit_name + record.suit_length + 1;
+        const char *message = case_name + record.case_length + 1;
+        size_t strings_size = record.file_length + record.suit_length + record.case_length +
+                              record.message_length + 4u;
+
+        if (record.size < header.record_size + strings_size || record.size > size - offset ||
+            record.status >= test_intern_ResultCount || message[record.message_length] != '\0') {
+            break;
+        }
+
+        test_runner_count_result((test_intern_Result)record.status);
+        test_results_print_record(&record, file_name, suit_name, case_name, message);
+        test_results.record_count++;
+
+        offset += record.size;
+    }
+
+    if (offset != size) {
+        fprintf(stderr, "[test]: Ignoring truncated or corrupted records: %s\n", path);
+        test_results.has_merge_errors = true;
+    }
+
+    munmap((void *)data, size);
+    return true;
+}
+
+/// Merge all results files, given as a comma separated list of files and directories.
+/// Returns false if any file could not be merged entirely, or any merged test case failed.
+static bool test_results_merge(void) {
+    char *paths = options.raw.merge_value;
+    char path_buffer[PATH_MAX];
+
+    // Files that can not be merged are reported, the remaining ones are still merged
+    for (char *path = strtok(paths, ","); path != NULL; path = strtok(NULL, ",")) {
+        DIR *directory = opendir(path);
+        if (directory == NULL) {
+            if (!test_results_merge_file(path, false)) {
+                test_results.has_merge_errors = true;
+            }
+            continue;
+        }
+
+        struct dirent *entry = NULL;
+        while ((entry = readdir(directory)) != NULL) {
+            struct stat info;
+            snprintf(path_buffer, sizeof(path_buffer), "%s/%s", path, entry->d_name);
+            if (stat(path_buffer, &info) != 0 || !S_ISREG(info.st_mode)) {
+                continue;
+            }
+
+            if (!test_results_merge_file(path_buffer, true)) {
+                test_results.has_merge_errors = true;
+            }
+        }
+        closedir(directory);
+    }
+
+    if (options.merge_format == test_intern_MergeJson) {
+        test_log_write((test_results.record_count == 0) ? "[]\n" : "\n]\n");
+    } else {
+        test_register.total_tests = test_results.record_count;
+        test_runner_report();
     }
+
+    return !test_results.has_merge_errors && test_runner.tests_failed == 0;
 }
 
 static bool test_parse_filter(void) {
@@ -591,7 +3385,69 @@ static void print_help(void) {
         "        Redirect library output to a new file.\n"
         "\n"
         "      --colored (auto|always|never)\n"
-        "        Colorize the output.\n";
+        "        Colorize the output.\n"
+        "\n"
+        "      --jobs <count>\n"
+        "        Number of worker processes used by --fuzz, --repeat and --until-fail.\n"
+        "        Defaults to 1.\n"
+        "\n"
+        "      --repeat <count>\n"
+        "        Run every selected test case <count> times, including its setup and teardown.\n"
+        "        Prints the stability and timing statistics of every case.\n"
+        "        Asynchronous test cases are not repeated.\n"
+        "\n"
+        "      --until-fail\n"
+        "        Like --repeat, but stop repeating a test case after its first failure.\n"
+        "        Uses the count of --repeat as upper bound, or 10000 if not specified.\n"
+        "\n"
+        "      --fuzz <corpus>\n"
+        "        Run all fuzz targets instead of the test cases. Respects filters.\n"
+        "        Every regular file inside the <corpus> directory is used as a seed input.\n"
+        "        Crashing inputs are saved to 'crash-<suit>-<target>-<hash>'.\n"
+        "\n"
+        "      --fuzz-runs <count>\n"
+        "        Number of mutated inputs per fuzz target and worker. Defaults to 100000.\n"
+        "\n"
+        "      --fuzz-dict <file>\n"
+        "        Dictionary of tokens used for mutations, in the AFL/libFuzzer format.\n"
+        "\n"
+        "      --results <file>\n"
+        "        Append the results of this run to <file>, using a compact binary format.\n"
+        "        Multiple processes can append to the same file.\n"
+        "\n"
+        "      --merge <files>\n"
+        "        Merge results files written by --results and print the combined report,\n"
+        "        instead of running any tests. A list of files and directories,\n"
+        "        separated by commas. Other files in directories are skipped.\n"
+        "        Exits with 1 if a file is invalid or truncated, or any test case failed.\n"
+        "\n"
+        "      --merge-format (report|text|json)\n"
+        "        Output format of --merge. 'text' and 'json' print every single result.\n"
+        "\n"
+        "      --changed-since <cache>\n"
+        "        Only run test cases whose source file changed since the run that wrote <cache>,\n"
+        "        new test cases and test cases that did not pass. Updates <cache> afterwards.\n"
+        "        Source files are only hashed if their modification time or size changed.\n"
+        "        If only the binary changed (e.g. code under test, headers), all test cases run.\n"
+        "        Code in shared libraries is not tracked.\n"
+        "\n"
+        "      --scratch-poison\n"
+        "        Poison scratch memory after every test case, to detect later uses of it.\n"
+        "        It is overwritten with 0xdb, or poisoned in builds with AddressSanitizer.\n"
+        "\n"
+        "      --cpus <list>\n"
+        "        Pin the runner to a set of CPUs, like '0-3,6'. Workers of --jobs are each\n"
+        "        pinned to a single CPU of the set, round robin.\n"
+        "\n"
+        "      --mlock\n"
+        "        Lock all memory with mlockall() and fault in the stack and heap up front.\n"
+        "\n"
+        "      --nice <value>\n"
+        "        Set the scheduling priority (-20 to 19). Raising it requires privileges.\n"
+        "\n"
+        "      --noise\n"
+        "        Report the context switches and CPU migrations during every test case.\n"
+        "        Asynchronous test cases are not measured.\n";
 
     printf("%s", help_text);
 }
@@ -623,6 +3479,51 @@ static bool test_parse_arguments(int argc, char **argv) {
         } else if (strcmp(argv[i], "--filter") == 0) {
             is_valid_argument = true;
             second_argument_target = &options.raw.filter_value;
+        } else if (strcmp(argv[i], "--until-fail") == 0) {
+            is_valid_argument = true;
+            options.until_fail = true;
+        } else if (strcmp(argv[i], "--scratch-poison") == 0) {
+            is_valid_argument = true;
+            options.scratch_poison = true;
+        } else if (strcmp(argv[i], "--mlock") == 0) {
+            is_valid_argument = true;
+            options.mlock = true;
+        } else if (strcmp(argv[i], "--noise") == 0) {
+            is_valid_argument = true;
+            options.noise = true;
+        } else if (strcmp(argv[i], "--cpus") == 0) {
+            is_valid_argument = true;
+            second_argument_target = &options.raw.cpus_value;
+        } else if (strcmp(argv[i], "--nice") == 0) {
+            is_valid_argument = true;
+            second_argument_target = &options.raw.nice_value;
+        } else if (strcmp(argv[i], "--repeat") == 0) {
+            is_valid_argument = true;
+            second_argument_target = &options.raw.repeat_value;
+        } else if (strcmp(argv[i], "--results") == 0) {
+            is_valid_argument = true;
+            second_argument_target = &options.raw.results_value;
+        } else if (strcmp(argv[i], "--merge") == 0) {
+            is_valid_argument = true;
+            second_argument_target = &options.raw.merge_value;
+        } else if (strcmp(argv[i], "--merge-format") == 0) {
+            is_valid_argument = true;
+            second_argument_target = &options.raw.merge_format_value;
+        } else if (strcmp(argv[i], "--changed-since") == 0) {
+            is_valid_argument = true;
+            second_argument_target = &options.raw.changed_since_value;
+        } else if (strcmp(argv[i], "--jobs") == 0) {
+            is_valid_argument = true;
+            second_argument_target = &options.raw.jobs_value;
+        } else if (strcmp(argv[i], "--fuzz") == 0) {
+            is_valid_argument = true;
+            second_argument_target = &options.raw.fuzz_value;
+        } else if (strcmp(argv[i], "--fuzz-runs") == 0) {
+            is_valid_argument = true;
+            second_argument_target = &options.raw.fuzz_runs_value;
+        } else if (strcmp(argv[i], "--fuzz-dict") == 0) {
+            is_valid_argument = true;
+            second_argument_target = &options.raw.fuzz_dict_value;
         }
 
         if (is_valid_argument == false) {
@@ -690,32 +3591,110 @@ static bool test_parse_options(void) {
         }
     }
 
-    return true;
-invalid_option:
-    fprintf(stderr, "[test]: Invalid option for flag '%s': %s\n", flag, option);
-    return false;
-}
+    option = options.raw.jobs_value;
+    flag = "--jobs";
+    options.jobs = 1;
+    if (option != NULL && (!test_parse_unsigned(option, &options.jobs) || options.jobs == 0)) {
+        goto invalid_option;
+    }
 
-bool test_init(int argc, char **argv) {
-    if (!test_parse_arguments(argc, argv)) {
-        return false;
+    option = options.raw.cpus_value;
+    flag = "--cpus";
+    if (option != NULL) {
+        if (!test_parse_cpus(option)) {
+            goto invalid_option;
+        }
+
+        // Workers are pinned to single CPUs, every one of them must be usable
+        cpu_set_t allowed;
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+            fprintf(stderr, "[test]: Failed to get CPU affinity: %s\n", strerror(errno));
+            return false;
+        }
+
+        for (uint32_t i = 0; i < options.cpu_count; i++) {
+            if (!CPU_ISSET(options.cpu_list[i], &allowed)) {
+                fprintf(
+                    stderr, "[test]: CPU %u of '--cpus' is not available\n", options.cpu_list[i]
+                );
+                return false;
+            }
+        }
     }
 
-    if (options.show_help) {
-        print_help();
+    option = options.raw.nice_value;
+    flag = "--nice";
+    if (option != NULL) {
+        char *end = NULL;
+        errno = 0;
+        long nice = strtol(option, &end, 10);
+        if (errno != 0 || end == option || *end != '\0' || nice < -20 || nice > 19) {
+            goto invalid_option;
+        }
+        options.nice = (int32_t)nice;
+    }
+
+    option = options.raw.merge_format_value;
+    flag = "--merge-format";
+    if (option == NULL || strcmp(option, "report") == 0) {
+        options.merge_format = test_intern_MergeReport;
+    } else if (strcmp(option, "text") == 0) {
+        options.merge_format = test_intern_MergeText;
+    } else if (strcmp(option, "json") == 0) {
+        options.merge_format = test_intern_MergeJson;
+    } else {
+        goto invalid_option;
+    }
+
+    option = options.raw.results_value;
+    if (option != NULL && !test_results_open(option)) {
         return false;
     }
 
-    if (!test_parse_options()) {
+    option = options.raw.repeat_value;
+    flag = "--repeat";
+    options.repeat = (options.until_fail) ? TEST_REPEAT_UNTIL_FAIL_DEFAULT : 0;
+    if (option != NULL && (!test_parse_unsigned(option, &options.repeat) || options.repeat == 0)) {
+        goto invalid_option;
+    }
+
+    option = options.raw.fuzz_runs_value;
+    flag = "--fuzz-runs";
+    options.fuzz_runs = TEST_FUZZ_RUNS_DEFAULT;
+    if (option != NULL && !test_parse_unsigned(option, &options.fuzz_runs)) {
+        goto invalid_option;
+    }
+
+    option = options.raw.fuzz_dict_value;
+    if (option != NULL && !test_fuzz_load_dict(option)) {
         return false;
     }
 
-    memset(&log_data, 0, sizeof(log_data));
-    memset(&test_runner, 0, sizeof(test_runner));
+    option = options.raw.fuzz_value;
+    if (option != NULL) {
+        if (!test_fuzz_load_corpus(option)) {
+            return false;
+        }
+
+        options.fuzz_corpus = option;
+    }
+
+    return true;
+invalid_option:
+    fprintf(stderr, "[test]: Invalid option for flag '%s': %s\n", flag, option);
+    return false;
+}
+
+/// Build the registry from the suits in [suit_begin, suit_end) and
+/// the test cases in [case_begin, case_end)
+static bool test_register_all(
+    test_intern_SuitData **suit_begin, test_intern_SuitData **suit_end,
+    test_intern_TestCase **case_begin, test_intern_TestCase **case_end
+) {
     memset(&test_register, 0, sizeof(test_register));
 
     // Register all suits
-    uintptr_t suit_count = &TEST_STOP_SUIT_SECTION - &TEST_START_SUIT_SECTION;
+    uintptr_t suit_count = suit_end - suit_begin;
     test_intern_assert(suit_count > 0);
     test_intern_assert(suit_count < (uint32_t)(-1));
 
@@ -724,7 +3703,7 @@ bool test_init(int argc, char **argv) {
 
     // Register all suits
     uint32_t suit_index = 0;
-    for (test_intern_SuitData **suit_data_iter = &TEST_START_SUIT_SECTION; suit_data_iter < &TEST_STOP_SUIT_SECTION; suit_data_iter++) {
+    for (test_intern_SuitData **suit_data_iter = suit_begin; suit_data_iter < suit_end; suit_data_iter++) {
         test_register.suit_list[suit_index++].suit_data = *suit_data_iter;
     }
 
@@ -732,8 +3711,8 @@ bool test_init(int argc, char **argv) {
     test_intern_Suit *current_suit = NULL;
 
     // Register all cases
-    for (test_intern_TestCase **test_case_iter = &TEST_START_CASE_SECTION;
-         test_case_iter < &TEST_STOP_CASE_SECTION; test_case_iter++) {
+    for (test_intern_TestCase **test_case_iter = case_begin; test_case_iter < case_end;
+         test_case_iter++) {
         const test_intern_TestCase *test_case = *test_case_iter;
 
         // It is (probably) likely that adjacent tests belong to the same suit
@@ -760,12 +3739,95 @@ bool test_init(int argc, char **argv) {
         last_suit = current_suit;
     }
 
+    return true;
+}
+
+static void test_register_free(void) {
+    for (uint32_t i = 0; i < test_register.total_suits; i++) {
+        free(test_register.suit_list[i].test_list);
+        free(test_register.suit_list[i].fuzz_list);
+    }
+
+    free(test_register.suit_list);
+    memset(&test_register, 0, sizeof(test_register));
+
+    // Refers to the freed suit list
+    free(test_scratch.suit_index.slots);
+    test_scratch.suit_index.slots = NULL;
+}
+
+bool test_init(int argc, char **argv) {
+    if (!test_parse_arguments(argc, argv)) {
+        return false;
+    }
+
+    if (options.show_help) {
+        print_help();
+        return false;
+    }
+
+    if (!test_parse_options()) {
+        return false;
+    }
+
+    memset(&log_data, 0, sizeof(log_data));
+    memset(&test_runner, 0, sizeof(test_runner));
+
+    // Exits directly (as documented), so that the status reflects the merged results
+    if (options.raw.merge_value != NULL) {
+        bool is_successful = test_results_merge();
+        test_exit();
+        exit(is_successful ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    if (!test_register_all(
+            &TEST_START_SUIT_SECTION, &TEST_STOP_SUIT_SECTION, &TEST_START_CASE_SECTION,
+            &TEST_STOP_CASE_SECTION
+        )) {
+        return false;
+    }
+
+    // Register all fuzz targets
+    for (test_intern_FuzzCase **fuzz_case_iter = &TEST_START_FUZZ_SECTION;
+         fuzz_case_iter < &TEST_STOP_FUZZ_SECTION; fuzz_case_iter++) {
+        const test_intern_FuzzCase *fuzz_case = *fuzz_case_iter;
+
+        test_intern_Suit *suit = test_suit_find_by_name(fuzz_case->suit_name);
+        if (suit == NULL) {
+            fprintf(
+                options.output_stream, "Unable to find suit \"%s\" for fuzz target \"%s\"\n",
+                fuzz_case->suit_name, fuzz_case->name
+            );
+            return false;
+        }
+
+        suit->fuzz_list =
+            test_realloc(suit->fuzz_list, sizeof(test_intern_FuzzCase * [suit->fuzz_count + 1]));
+
+        suit->fuzz_list[suit->fuzz_count] = fuzz_case;
+        suit->fuzz_count++;
+        test_register.total_fuzz_targets++;
+    }
+
+    if (options.raw.changed_since_value != NULL) {
+        test_changes.cache_path = options.raw.changed_since_value;
+        if (!test_changes_prepare()) {
+            test_exit();
+            return false;
+        }
+    }
+
     if (options.print_list) {
         test_list_all();
         test_exit();
         return false;
     }
 
+    if (!test_isolate_process()) {
+        test_exit();
+        return false;
+    }
+
     return true;
 }
 
@@ -774,11 +3836,33 @@ void test_exit(void) {
         fclose(options.output_stream);
     }
 
-    for (uint32_t i = 0; i < test_register.total_suits; i++) {
-        free(test_register.suit_list[i].test_list);
+    if (test_results.fd >= 0) {
+        close(test_results.fd);
+        test_results.fd = -1;
     }
+    free(test_results.buffer);
+    test_results.buffer = NULL;
+    test_results.buffer_size = 0;
 
-    free(test_register.suit_list);
+    test_register_free();
+    test_changes_free();
+    test_scratch_free();
+    test_noise_free();
+
+    free(test_runner.repeat_tests);
+    free(test_runner.repeat_suits);
+    free(test_runner.repeat_stats);
+
+    for (uint32_t i = 0; i < test_fuzzer.corpus_count; i++) {
+        free(test_fuzzer.corpus[i].data);
+    }
+    for (uint32_t i = 0; i < test_fuzzer.dict_count; i++) {
+        free(test_fuzzer.dict[i].data);
+    }
+
+    free(test_fuzzer.corpus);
+    free(test_fuzzer.mutation_buffer);
+    free(test_fuzzer.input_buffer);
 }
 
 #endif
@@ -1,6 +1,4 @@
-#ifndef TEST_IMPLEMENTATION
-#define TEST_IMPLEMENTATION
-#endif
+// The implementation is part of test_internal.c
 #include <test/test.h>
 
 #include <stdbool.h>
@@ -0,0 +1,95 @@
+#include <test/test.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+ASYNC_CALLBACK(on_ping) {
+    char buffer[8] = { 0 };
+    test_assert_eq(read(fd, buffer, sizeof(buffer)), 4);
+    test_assert_string_eq(buffer, "ping");
+
+    test_async_unwatch(fd);
+    close(fd);
+    close((int)(intptr_t)user_data);
+}
+
+SUIT(async, NULL, NULL);
+ASYNC_TEST(async, socketpair, 1000) {
+    int fds[2];
+    test_assert_eq(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds), 0);
+
+    test_assert(test_async_watch(fds[1], EPOLLIN, on_ping, (void *)(intptr_t)fds[0]));
+    test_assert_eq(write(fds[0], "ping", 4), 4);
+}
+
+static struct {
+    int server;
+    int client;
+    int connection;
+} loopback = { -1, -1, -1 };
+
+ASYNC_CALLBACK(on_reply) {
+    char buffer[8] = { 0 };
+    test_assert_eq(read(fd, buffer, sizeof(buffer)), 5);
+    test_assert_string_eq(buffer, "hello");
+
+    test_async_done();
+}
+
+ASYNC_CALLBACK(on_accept) {
+    loopback.connection = accept(fd, NULL, NULL);
+    test_assert(loopback.connection >= 0);
+    test_assert_eq(write(loopback.connection, "hello", 5), 5);
+
+    test_async_unwatch(fd);
+}
+
+static void loopback_teardown(void) {
+    int *fds[] = { &loopback.server, &loopback.client, &loopback.connection };
+    for (uint32_t i = 0; i < sizeof(fds) / sizeof(fds[0]); i++) {
+        if (*fds[i] >= 0) {
+            test_async_unwatch(*fds[i]);
+            close(*fds[i]);
+            *fds[i] = -1;
+        }
+    }
+}
+
+SUIT(async_loopback, NULL, loopback_teardown);
+ASYNC_TEST(async_loopback, tcp_echo, 1000) {
+    struct sockaddr_in address = { 0 };
+    socklen_t address_length = sizeof(address);
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    loopback.server = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    test_assert(loopback.server >= 0);
+    test_assert_eq(bind(loopback.server, (struct sockaddr *)&address, sizeof(address)), 0);
+    test_assert_eq(listen(loopback.server, 1), 0);
+    test_assert_eq(getsockname(loopback.server, (struct sockaddr *)&address, &address_length), 0);
+
+    loopback.client = socket(AF_INET, SOCK_STREAM, 0);
+    test_assert(loopback.client >= 0);
+    test_assert_eq(connect(loopback.client, (struct sockaddr *)&address, sizeof(address)), 0);
+
+    test_assert(test_async_watch(loopback.server, EPOLLIN, on_accept, NULL));
+    test_assert(test_async_watch(loopback.client, EPOLLIN, on_reply, NULL));
+}
+
+ASYNC_CALLBACK(on_never) { test_assert(false); }
+
+static int silent_fds[2] = { -1, -1 };
+
+static void silent_teardown(void) {
+    close(silent_fds[0]);
+    close(silent_fds[1]);
+}
+
+SUIT(async_false, NULL, silent_teardown);
+ASYNC_TEST(async_false, timeout, 50) {
+    test_assert_eq(socketpair(AF_UNIX, SOCK_STREAM, 0, silent_fds), 0);
+    test_assert(test_async_watch(silent_fds[0], EPOLLIN, on_never, NULL));
+}
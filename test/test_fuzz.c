@@ -0,0 +1,34 @@
+#include <test/test.h>
+
+// Parse a decimal number, saturating on overflow. Returns the number of consumed bytes.
+static size_t parse_decimal(const uint8_t *data, size_t size, uint32_t *value) {
+    size_t offset = 0;
+    *value = 0;
+
+    while (offset < size && data[offset] >= '0' && data[offset] <= '9') {
+        uint32_t digit = (uint32_t)(data[offset] - '0');
+        *value = (*value > (UINT32_MAX - digit) / 10) ? UINT32_MAX : *value * 10 + digit;
+        offset++;
+    }
+
+    return offset;
+}
+
+SUIT(fuzzing, NULL, NULL);
+TEST(fuzzing, parse_decimal) {
+    uint32_t value = 0;
+
+    test_assert_eq(parse_decimal((const uint8_t *)"1234abc", 7, &value), 4);
+    test_assert_eq(value, 1234);
+
+    test_assert_eq(parse_decimal((const uint8_t *)"99999999999", 11, &value), 11);
+    test_assert_eq(value, UINT32_MAX);
+}
+
+FUZZ(fuzzing, parse_decimal) {
+    uint32_t value = 0;
+    size_t consumed = parse_decimal(data, size, &value);
+
+    test_assert(consumed <= size);
+    test_assert(consumed == size || data[consumed] < '0' || data[consumed] > '9');
+}
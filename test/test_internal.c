@@ -0,0 +1,787 @@
+// Tests of the libraries internals. This is the translation unit with the implementation,
+// so that its static functions and state are accessible.
+#define TEST_IMPLEMENTATION
+#include <test/test.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+static void internal_empty_case(test_intern_Result *_result) { (void)_result; }
+
+/// Library state replaced by the test cases, which is restored after each of them
+static struct {
+    uint8_t test_register[sizeof(test_register)];
+    uint8_t test_results[sizeof(test_results)];
+    uint8_t test_changes[sizeof(test_changes)];
+    uint8_t test_runner[sizeof(test_runner)];
+    uint8_t log_data[sizeof(log_data)];
+    uint8_t test_fuzzer[sizeof(test_fuzzer)];
+    uint8_t options[sizeof(options)];
+} internal_saved;
+
+static void internal_save_state(void) {
+    memcpy(internal_saved.test_register, &test_register, sizeof(test_register));
+    memcpy(internal_saved.test_results, &test_results, sizeof(test_results));
+    memcpy(internal_saved.test_changes, &test_changes, sizeof(test_changes));
+    memcpy(internal_saved.test_runner, &test_runner, sizeof(test_runner));
+    memcpy(internal_saved.log_data, &log_data, sizeof(log_data));
+    memcpy(internal_saved.test_fuzzer, &test_fuzzer, sizeof(test_fuzzer));
+    memcpy(internal_saved.options, &options, sizeof(options));
+}
+
+static void internal_restore_state(void) {
+    memcpy(&test_register, internal_saved.test_register, sizeof(test_register));
+    memcpy(&test_results, internal_saved.test_results, sizeof(test_results));
+    memcpy(&test_changes, internal_saved.test_changes, sizeof(test_changes));
+    memcpy(&test_runner, internal_saved.test_runner, sizeof(test_runner));
+    memcpy(&log_data, internal_saved.log_data, sizeof(log_data));
+    memcpy(&test_fuzzer, internal_saved.test_fuzzer, sizeof(test_fuzzer));
+    memcpy(&options, internal_saved.options, sizeof(options));
+}
+
+static bool internal_write_file(const char *path, const char *mode, const char *text) {
+    FILE *file = fopen(path, mode);
+    if (file == NULL) {
+        return false;
+    }
+
+    fputs(text, file);
+    return fclose(file) == 0;
+}
+
+#define INTERNAL_PATH_SIZE 32
+
+/// Create an empty temporary file, its path is stored in 'path'
+static bool internal_temp_file(char path[INTERNAL_PATH_SIZE], const char *name) {
+    // The template is replaced by mkstemp(), so it is recreated every time
+    snprintf(path, INTERNAL_PATH_SIZE, "/tmp/libtest_%s_XXXXXX", name);
+    int fd = mkstemp(path);
+    return fd >= 0 && close(fd) == 0;
+}
+
+/* Change tracking */
+static test_intern_SuitData changes_suit = { .name = "synthetic" };
+static test_intern_TestCase changes_cases[] = {
+    { .line = 1, .name = "first", .suit_name = "synthetic", .function = internal_empty_case },
+    { .line = 2, .name = "second", .suit_name = "synthetic", .function = internal_empty_case },
+    { .line = 3, .name = "third", .suit_name = "synthetic", .function = internal_empty_case },
+};
+
+static char changes_cache_path[INTERNAL_PATH_SIZE];
+static char changes_source_a[INTERNAL_PATH_SIZE];
+static char changes_source_b[INTERNAL_PATH_SIZE];
+
+/// Start a new run using the cache. Returns the number of selected test cases
+static uint32_t changes_select(void) {
+    test_changes_free();
+    test_changes.cache_path = changes_cache_path;
+    return test_changes_prepare() ? test_changes.selected_count : UINT32_MAX;
+}
+
+/// Pretend the binary was rebuilt, by clearing its hash in the cache
+static bool changes_clear_binary_hash(void) {
+    char buffer[4096];
+    FILE *cache = fopen(changes_cache_path, "r");
+    if (cache == NULL) {
+        return false;
+    }
+    size_t length = fread(buffer, 1, sizeof(buffer) - 1, cache);
+    fclose(cache);
+    buffer[length] = '\0';
+
+    char *hash = strstr(buffer, "binary ");
+    if (hash == NULL) {
+        return false;
+    }
+    memset(hash + 7, '0', 16);
+
+    return internal_write_file(changes_cache_path, "w", buffer);
+}
+
+static void changes_across_runs(test_intern_Result *_result) {
+    // The first run, without a cache, selects everything
+    test_assert_eq(changes_select(), 3);
+    test_changes_record(&changes_cases[0], test_intern_ResultOk);
+    test_changes_record(&changes_cases[1], test_intern_ResultOk);
+    test_changes_record(&changes_cases[2], test_intern_ResultFailed);
+    test_changes_save();
+
+    // Only the failed test case
+    test_assert_eq(changes_select(), 1);
+    test_assert(!test_changes_is_selected(&changes_cases[0]));
+    test_assert(test_changes_is_selected(&changes_cases[2]));
+    test_changes_save();
+
+    // A new modification time alone does not change the source
+    test_assert_eq(utimensat(AT_FDCWD, changes_source_b, NULL, 0), 0);
+    test_assert_eq(changes_select(), 1);
+    test_changes_save();
+
+    // Changed source 'a' and the still failing test case
+    test_assert(internal_write_file(changes_source_a, "a", "// changed\n"));
+    test_assert_eq(changes_select(), 2);
+    test_assert(test_changes_is_selected(&changes_cases[0]));
+    test_assert(!test_changes_is_selected(&changes_cases[1]));
+    test_changes_record(&changes_cases[0], test_intern_ResultOk);
+    test_changes_record(&changes_cases[2], test_intern_ResultOk);
+    test_changes_save();
+
+    test_assert_eq(changes_select(), 0);
+    test_changes_save();
+
+    // Selected test cases that did not run (e.g. excluded by a filter) stay selected
+    test_assert(internal_write_file(changes_source_b, "a", "// changed\n"));
+    test_assert_eq(changes_select(), 2);
+    test_changes_record(&changes_cases[1], test_intern_ResultOk);
+    test_changes_save();
+
+    test_assert_eq(changes_select(), 1);
+    test_assert(test_changes_is_selected(&changes_cases[2]));
+    test_changes_record(&changes_cases[2], test_intern_ResultOk);
+    test_changes_save();
+
+    test_assert_eq(changes_select(), 0);
+    test_changes_save();
+
+    // A changed binary without changed sources selects everything, also for the next run
+    test_assert(changes_clear_binary_hash());
+    test_assert_eq(changes_select(), 3);
+    test_changes_record(&changes_cases[0], test_intern_ResultOk);
+    test_changes_save();
+
+    test_assert_eq(changes_select(), 2);
+    test_assert(!test_changes_is_selected(&changes_cases[0]));
+}
+
+SUIT(changes, NULL, NULL);
+TEST(changes, across_runs) {
+    test_assert(internal_temp_file(changes_cache_path, "cache"));
+    test_assert(internal_temp_file(changes_source_a, "a"));
+    test_assert(internal_temp_file(changes_source_b, "b"));
+    test_assert(internal_write_file(changes_source_a, "w", "// a\n"));
+    test_assert(internal_write_file(changes_source_b, "w", "// b\n"));
+
+    // The first two test cases share a source file
+    changes_cases[0].file_name = changes_source_a;
+    changes_cases[1].file_name = changes_source_b;
+    changes_cases[2].file_name = changes_source_b;
+
+    // The registry and change tracking state of this run are replaced by a synthetic one
+    internal_save_state();
+    memset(&test_changes, 0, sizeof(test_changes));
+
+    test_intern_SuitData *suits[] = { &changes_suit };
+    test_intern_TestCase *cases[] = { &changes_cases[0], &changes_cases[1], &changes_cases[2] };
+    bool is_registered = test_register_all(suits, suits + 1, cases, cases + 3);
+    if (is_registered) {
+        changes_across_runs(_result);
+    }
+
+    test_changes_free();
+    test_register_free();
+    internal_restore_state();
+
+    unlink(changes_source_a);
+    unlink(changes_source_b);
+    unlink(changes_cache_path);
+
+    test_assert(is_registered);
+}
+
+/* Results */
+static char results_directory[INTERNAL_PATH_SIZE];
+static char results_path[INTERNAL_PATH_SIZE + 16];
+static char results_notes_path[INTERNAL_PATH_SIZE + 16];
+static test_intern_LogCapture results_output;
+
+/// Merge 'paths' in 'format', the output is stored in 'results_output'
+static bool results_merge(const char *paths, test_intern_MergeFormat format) {
+    char paths_buffer[sizeof(results_path) * 2];
+    strcpy(paths_buffer, paths);
+
+    memset(&test_runner, 0, sizeof(test_runner));
+    test_results.record_count = 0;
+    test_results.has_merge_errors = false;
+    options.raw.merge_value = paths_buffer;
+    options.merge_format = format;
+
+    // The output of this test case itself may be captured as well
+    test_intern_LogCapture *capture = log_data.capture;
+    memset(&results_output, 0, sizeof(results_output));
+    log_data.capture = &results_output;
+    bool is_successful = test_results_merge();
+    log_data.capture = capture;
+
+    return is_successful;
+}
+
+static bool results_output_ends_with(const char *suffix) {
+    size_t length = strlen(results_output.buffer);
+    return length >= strlen(suffix) &&
+           strcmp(results_output.buffer + length - strlen(suffix), suffix) == 0;
+}
+
+static void results_write_and_merge(test_intern_Result *_result) {
+    test_assert(test_results_open(results_path));
+
+    test_intern_RepeatStats stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.runs = 3;
+    stats.results[test_intern_ResultFailed] = 1;
+    strcpy(stats.failure.buffer, "failed at 1: \"quoted\"");
+    test_results_write("a.c", 10, "suit", "first", test_intern_ResultFailed, &stats);
+
+    memset(&stats, 0, sizeof(stats));
+    stats.runs = 1;
+    test_results_write("b.c", 20, "suit", "second", test_intern_ResultOk, &stats);
+
+    close(test_results.fd);
+    test_results.fd = -1;
+
+    // A failed test case fails the merge
+    test_assert(!results_merge(results_path, test_intern_MergeJson));
+    test_assert_eq(test_results.record_count, 2);
+    test_assert(!test_results.has_merge_errors);
+    const char *output = results_output.buffer;
+    test_assert(strstr(output, "\"case\": \"first\", \"status\": \"failed\"") != NULL);
+    test_assert(strstr(output, "\"runs\": 3, \"failures\": 1") != NULL);
+    test_assert(strstr(output, "\"message\": \"failed at 1: \\\"quoted\\\"\"") != NULL);
+    test_assert(strstr(output, "\"case\": \"second\", \"status\": \"ok\"") != NULL);
+    test_assert(results_output_ends_with("}\n]\n"));
+
+    // Other files in a directory are skipped
+    test_assert(internal_write_file(results_notes_path, "w", "notes\n"));
+    test_assert(!results_merge(results_directory, test_intern_MergeJson));
+    test_assert_eq(test_results.record_count, 2);
+    test_assert(!test_results.has_merge_errors);
+    test_assert(results_output_ends_with("}\n]\n"));
+
+    // Records before a truncated one are still merged
+    FILE *file = fopen(results_path, "a");
+    test_assert(file != NULL);
+    fwrite("\x40\x00\x00\x00truncated", 1, 13, file);
+    fclose(file);
+
+    test_assert(!results_merge(results_directory, test_intern_MergeText));
+    test_assert_eq(test_results.record_count, 2);
+    test_assert(test_results.has_merge_errors);
+    test_assert(strstr(results_output.buffer, "b.c @ 20 'suit:second': ok (1 runs") != NULL);
+
+    // Files given explicitly must be results files, the others are still merged and reported
+    char paths[sizeof(results_path) * 2];
+    snprintf(paths, sizeof(paths), "%s,%s", results_notes_path, results_path);
+    test_assert(!results_merge(paths, test_intern_MergeReport));
+    test_assert_eq(test_results.record_count, 2);
+    test_assert(test_results.has_merge_errors);
+    test_assert(strstr(results_output.buffer, "attempted to run 2 out of 2 tests") != NULL);
+
+    test_assert(internal_write_file(results_path, "w", "LTRX not a results file"));
+    test_assert(!results_merge(results_path, test_intern_MergeJson));
+    test_assert_eq(test_results.record_count, 0);
+    test_assert_string_eq(results_output.buffer, "[]\n");
+}
+
+SUIT(results, NULL, NULL);
+TEST(results, write_and_merge) {
+    strcpy(results_directory, "/tmp/libtest_results_XXXXXX");
+    test_assert(mkdtemp(results_directory) != NULL);
+    snprintf(results_path, sizeof(results_path), "%s/a.bin", results_directory);
+    snprintf(results_notes_path, sizeof(results_notes_path), "%s/notes.txt", results_directory);
+
+    internal_save_state();
+    memset(&test_results, 0, sizeof(test_results));
+    test_results.fd = -1;
+
+    results_write_and_merge(_result);
+
+    if (test_results.fd >= 0) {
+        close(test_results.fd);
+    }
+    free(test_results.buffer);
+    internal_restore_state();
+
+    unlink(results_path);
+    unlink(results_notes_path);
+    rmdir(results_directory);
+}
+
+/* Fuzzer */
+static void fuzzer_mutate_bounds(test_intern_Result *_result) {
+    static const uint32_t max_sizes[] = { 0, 1, 2, 17, 64 };
+
+    for (uint32_t i = 0; i < sizeof(max_sizes) / sizeof(max_sizes[0]); i++) {
+        // Exactly sized, so that the sanitizers catch writes past the end
+        uint32_t max_size = max_sizes[i];
+        uint8_t *data = malloc(max_size + (max_size == 0));
+        test_assert(data != NULL);
+
+        // Grows up to and shrinks down to the edges, which are hit repeatedly
+        uint32_t size = 0;
+        bool has_reached_max = (max_size == 0);
+        for (uint32_t run = 0; run < 20000; run++) {
+            size = test_fuzz_mutate(data, size, max_size);
+            has_reached_max |= (size == max_size);
+            if (size > max_size) {
+                break;
+            }
+        }
+        free(data);
+
+        test_assert(size <= max_size);
+        test_assert(has_reached_max);
+    }
+}
+
+static void fuzzer_insert_edges(test_intern_Result *_result) {
+    bool is_inserted_first = false;
+    bool is_inserted_last = false;
+
+    for (uint32_t run = 0; run < 1000; run++) {
+        uint8_t data[8] = "abcd";
+        test_assert_eq(test_fuzz_insert(data, 4, sizeof(data), (const uint8_t *)"XY", 2), 6);
+
+        uint8_t *inserted = memchr(data, 'X', 6);
+        test_assert(inserted != NULL && inserted[1] == 'Y');
+        is_inserted_first |= (inserted == data);
+        is_inserted_last |= (inserted == data + 4);
+
+        // The original bytes keep their order
+        memmove(inserted, inserted + 2, (size_t)(data + 6 - inserted - 2));
+        test_assert_memory_eq(data, "abcd", 4);
+    }
+
+    test_assert(is_inserted_first);
+    test_assert(is_inserted_last);
+
+    // Insertions are cut off at the maximum size
+    uint8_t data[8] = "abcdefg";
+    test_assert_eq(test_fuzz_insert(data, 7, sizeof(data), (const uint8_t *)"XY", 2), 8);
+}
+
+static void fuzzer_load_dict(test_intern_Result *_result, const char *path) {
+    test_assert(internal_write_file(
+        path, "w",
+        "# comment\n"
+        "\n"
+        "  keyword=\"GET\"\n"
+        "\"\\x41\\\\\\\"B\"\n"
+        "empty=\"\"\n"
+        "last=\"end\""
+    ));
+    test_assert(test_fuzz_load_dict(path));
+    test_assert_eq(test_fuzzer.dict_count, 3);
+    test_assert_eq(test_fuzzer.dict[0].size, 3);
+    test_assert_memory_eq(test_fuzzer.dict[0].data, "GET", 3);
+    test_assert_eq(test_fuzzer.dict[1].size, 4);
+    test_assert_memory_eq(test_fuzzer.dict[1].data, "A\\\"B", 4);
+    test_assert_eq(test_fuzzer.dict[2].size, 3);
+
+    static const char *invalid_lines[] = {
+        "no_quotes\n", "\"unterminated\n", "\"\\q\"\n", "\"\\x4\"\n", "\"trailing\\\"\n",
+    };
+    for (uint32_t i = 0; i < sizeof(invalid_lines) / sizeof(invalid_lines[0]); i++) {
+        test_assert(internal_write_file(path, "w", invalid_lines[i]));
+        test_assert(!test_fuzz_load_dict(path));
+    }
+
+    // Longer lines are rejected, instead of being split
+    char line[TEST_FUZZ_DICT_LINE_LIMIT + 16];
+    memset(line, 'a', sizeof(line));
+    line[0] = '"';
+    line[sizeof(line) - 3] = '"';
+    line[sizeof(line) - 2] = '\n';
+    line[sizeof(line) - 1] = '\0';
+    test_assert(internal_write_file(path, "w", line));
+    test_assert(!test_fuzz_load_dict(path));
+
+    // Exactly at the limit
+    line[TEST_FUZZ_DICT_LINE_LIMIT - 1] = '"';
+    line[TEST_FUZZ_DICT_LINE_LIMIT] = '\n';
+    line[TEST_FUZZ_DICT_LINE_LIMIT + 1] = '\0';
+    test_assert(internal_write_file(path, "w", line));
+    test_assert(test_fuzz_load_dict(path));
+}
+
+SUIT(fuzzer, NULL, NULL);
+TEST(fuzzer, mutate) {
+    internal_save_state();
+
+    // Corpus entries and dictionary tokens are used for splicing
+    static uint8_t corpus_data[] = "corpus entry";
+    static uint8_t token_data[] = "token";
+    test_intern_FuzzInput corpus = { sizeof(corpus_data) - 1, corpus_data };
+    test_fuzzer.random_state = 0x9e3779b97f4a7c15ULL;
+    test_fuzzer.corpus = &corpus;
+    test_fuzzer.corpus_count = 1;
+    test_fuzzer.dict[0].data = token_data;
+    test_fuzzer.dict[0].size = sizeof(token_data) - 1;
+    test_fuzzer.dict_count = 1;
+
+    fuzzer_mutate_bounds(_result);
+    if (*_result != test_intern_ResultFailed) {
+        fuzzer_insert_edges(_result);
+    }
+
+    internal_restore_state();
+}
+
+TEST(fuzzer, load_dict) {
+    char path[INTERNAL_PATH_SIZE];
+    test_assert(internal_temp_file(path, "dict"));
+
+    internal_save_state();
+    test_fuzzer.dict_count = 0;
+
+    fuzzer_load_dict(_result, path);
+
+    for (uint32_t i = 0; i < test_fuzzer.dict_count; i++) {
+        free(test_fuzzer.dict[i].data);
+    }
+    internal_restore_state();
+    unlink(path);
+}
+
+/* Scratch memory */
+ASYNC_CALLBACK(scratch_on_readable) {
+    // Allocations of callbacks belong to the test case as well
+    test_scratch_alloc(24);
+    test_assert_eq(test_async.current->scratch.used, 1008 + 24);
+
+    test_async_unwatch(fd);
+    close(fd);
+    close((int)(intptr_t)user_data);
+}
+
+/// Allocate scratch memory and wait for a pipe, so that the test cases run at the same time
+static void scratch_async_case(test_intern_Result *_result) {
+    uint8_t *buffer = test_scratch_alloc(1000);
+    test_assert(buffer == test_async.current->scratch.base);
+    test_assert_eq(test_async.current->scratch.used, 1000);
+    memset(buffer, 0, 1000);
+
+    int fds[2];
+    test_assert_eq(pipe(fds), 0);
+    test_assert_eq(write(fds[1], "x", 1), 1);
+    test_assert(test_async_watch(fds[0], EPOLLIN, scratch_on_readable, (void *)(intptr_t)fds[1]));
+}
+
+SUIT(scratch_async, NULL, NULL);
+ASYNC_TEST(scratch_async, first, 1000) { scratch_async_case(_result); }
+ASYNC_TEST(scratch_async, second, 1000) { scratch_async_case(_result); }
+ASYNC_TEST(scratch_async, third, 1000) { scratch_async_case(_result); }
+
+/* Repeated test cases */
+static const uint64_t repeat_durations[] = { 120, 80, 95, 300, 101, 99, 87, 1000, 110, 92 };
+#define REPEAT_DURATION_COUNT (sizeof(repeat_durations) / sizeof(repeat_durations[0]))
+
+/// Statistics of the runs with the durations 'begin' to 'end' (exclusive)
+static test_intern_RepeatStats repeat_stats_of(uint32_t begin, uint32_t end) {
+    test_intern_RepeatStats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    for (uint32_t i = begin; i < end; i++) {
+        test_intern_RunSample sample = { .duration_ns = repeat_durations[i] };
+        test_repeat_update(&stats, test_intern_ResultOk, &sample);
+    }
+
+    return stats;
+}
+
+static bool repeat_is_close(double value, double expected) {
+    double difference = (value > expected) ? value - expected : expected - value;
+    return difference <= 1e-9 * (1 + ((expected > 0) ? expected : -expected));
+}
+
+SUIT(repeats, NULL, NULL);
+TEST(repeats, merge) {
+    double mean = 0;
+    for (uint32_t i = 0; i < REPEAT_DURATION_COUNT; i++) {
+        mean += (double)repeat_durations[i] / REPEAT_DURATION_COUNT;
+    }
+    double m2 = 0;
+    for (uint32_t i = 0; i < REPEAT_DURATION_COUNT; i++) {
+        m2 += ((double)repeat_durations[i] - mean) * ((double)repeat_durations[i] - mean);
+    }
+
+    test_intern_RepeatStats single_pass = repeat_stats_of(0, REPEAT_DURATION_COUNT);
+    test_assert_eq(single_pass.runs, REPEAT_DURATION_COUNT);
+    test_assert(repeat_is_close(single_pass.mean_ns, mean));
+    test_assert(repeat_is_close(single_pass.m2_ns, m2));
+    test_assert_eq(single_pass.min_ns, 80);
+    test_assert_eq(single_pass.max_ns, 1000);
+
+    // Every split into two workers, including workers without any runs
+    for (uint32_t split = 0; split <= REPEAT_DURATION_COUNT; split++) {
+        test_intern_RepeatStats merged;
+        memset(&merged, 0, sizeof(merged));
+        test_intern_RepeatStats first = repeat_stats_of(0, split);
+        test_intern_RepeatStats second = repeat_stats_of(split, REPEAT_DURATION_COUNT);
+        test_repeat_merge(&merged, &first);
+        test_repeat_merge(&merged, &second);
+
+        test_assert_eq(merged.runs, REPEAT_DURATION_COUNT);
+        test_assert_eq(merged.results[test_intern_ResultOk], REPEAT_DURATION_COUNT);
+        test_assert(repeat_is_close(merged.mean_ns, mean));
+        test_assert(repeat_is_close(merged.m2_ns, m2));
+        test_assert_eq(merged.min_ns, 80);
+        test_assert_eq(merged.max_ns, 1000);
+    }
+
+    // Crashed runs are counted, but do not change the timing statistics
+    test_intern_RepeatStats crashed;
+    memset(&crashed, 0, sizeof(crashed));
+    test_repeat_fail_run(&crashed, "worker %u crashed: ", 1);
+    test_assert_string_eq(crashed.failure.buffer, "worker 1 crashed: ");
+
+    test_intern_RepeatStats merged;
+    memset(&merged, 0, sizeof(merged));
+    test_repeat_merge(&merged, &crashed);
+    test_repeat_merge(&merged, &single_pass);
+    test_assert_eq(merged.runs, REPEAT_DURATION_COUNT);
+    test_assert_eq(merged.crashed_runs, 1);
+    test_assert_eq(merged.results[test_intern_ResultFailed], 1);
+    test_assert(repeat_is_close(merged.mean_ns, mean));
+    test_assert(repeat_is_close(merged.m2_ns, m2));
+    test_assert_eq(merged.min_ns, 80);
+}
+
+TEST(repeats, status) {
+    test_intern_RepeatStats stats;
+    memset(&stats, 0, sizeof(stats));
+    test_assert_string_eq(test_repeat_status(&stats), "skipped");
+    test_assert_eq(test_repeat_result(&stats), test_intern_ResultSkipped);
+
+    stats.runs = 3;
+    stats.results[test_intern_ResultOk] = 3;
+    test_assert_string_eq(test_repeat_status(&stats), "stable");
+    test_assert_eq(test_repeat_result(&stats), test_intern_ResultOk);
+
+    stats.results[test_intern_ResultOk] = 2;
+    stats.results[test_intern_ResultPartiallyOk] = 1;
+    test_assert_string_eq(test_repeat_status(&stats), "stable");
+    test_assert_eq(test_repeat_result(&stats), test_intern_ResultPartiallyOk);
+
+    stats.results[test_intern_ResultPartiallyOk] = 0;
+    stats.results[test_intern_ResultFailed] = 1;
+    test_assert_string_eq(test_repeat_status(&stats), "flaky");
+    test_assert_eq(test_repeat_result(&stats), test_intern_ResultFailed);
+
+    stats.results[test_intern_ResultOk] = 0;
+    stats.results[test_intern_ResultFailed] = 3;
+    test_assert_string_eq(test_repeat_status(&stats), "failing");
+
+    // Runs of crashed workers only count as failures
+    memset(&stats, 0, sizeof(stats));
+    stats.crashed_runs = 1;
+    stats.results[test_intern_ResultFailed] = 1;
+    test_assert_string_eq(test_repeat_status(&stats), "failing");
+    test_assert_eq(test_repeat_result(&stats), test_intern_ResultFailed);
+
+    stats.runs = 1;
+    stats.results[test_intern_ResultOk] = 1;
+    test_assert_string_eq(test_repeat_status(&stats), "flaky");
+}
+
+static uint32_t repeat_calls = 0;
+
+static void repeat_fail_third(test_intern_Result *_result) {
+    repeat_calls++;
+    test_assert(repeat_calls != 3);
+}
+
+static void repeat_exit(test_intern_Result *_result) {
+    (void)_result;
+    _exit(3);
+}
+
+static test_intern_SuitData repeat_suit = { .name = "synthetic" };
+static const test_intern_TestCase repeat_cases[] = {
+    { .line = 1, .name = "fail_third", .suit_name = "synthetic", .file_name = __FILE__,
+      .function = repeat_fail_third },
+    { .line = 2, .name = "exit", .suit_name = "synthetic", .file_name = __FILE__,
+      .function = repeat_exit },
+    { .line = 3, .name = "never", .suit_name = "synthetic", .file_name = __FILE__,
+      .function = internal_empty_case },
+};
+
+/// Replace the queued test cases and the options of this run with a synthetic one
+static void repeat_prepare(const test_intern_TestCase **tests, uint32_t count) {
+    static const test_intern_SuitData *suits[] = { &repeat_suit, &repeat_suit, &repeat_suit };
+
+    memset(&test_runner, 0, sizeof(test_runner));
+    test_runner.repeat_count = count;
+    test_runner.repeat_tests = tests;
+    test_runner.repeat_suits = suits;
+
+    test_results.fd = -1;
+    test_changes.cache_path = NULL;
+    options.cpu_count = 0;
+    options.mlock = false;
+    options.noise = false;
+}
+
+static void repeat_until_fail(test_intern_Result *_result) {
+    const test_intern_TestCase *tests[] = { &repeat_cases[0] };
+    repeat_prepare(tests, 1);
+    options.repeat = 10;
+    options.jobs = 1;
+
+    // Stops after the first failed run
+    test_intern_LogCapture *capture = log_data.capture;
+    test_intern_RepeatStats stats;
+    memset(&stats, 0, sizeof(stats));
+    uint32_t current_case = 0;
+    repeat_calls = 0;
+    options.until_fail = true;
+    test_repeat_worker(0, &stats, &current_case);
+    log_data.capture = capture;
+
+    test_assert_eq(stats.runs, 3);
+    test_assert_eq(stats.results[test_intern_ResultFailed], 1);
+    test_assert(strstr(stats.failure.buffer, "repeat_calls != 3") != NULL);
+    test_assert_eq(current_case, UINT32_MAX);
+
+    // Runs all repetitions otherwise
+    memset(&stats, 0, sizeof(stats));
+    repeat_calls = 0;
+    options.until_fail = false;
+    test_repeat_worker(0, &stats, &current_case);
+    log_data.capture = capture;
+
+    test_assert_eq(stats.runs, 10);
+    test_assert_eq(stats.results[test_intern_ResultFailed], 1);
+}
+
+static void repeat_workers_exit(test_intern_Result *_result) {
+    // Both workers exit in the first test case and never run the second one
+    const test_intern_TestCase *tests[] = { &repeat_cases[1], &repeat_cases[2] };
+    repeat_prepare(tests, 2);
+    options.repeat = 4;
+    options.jobs = 2;
+    options.until_fail = false;
+
+    // The report of the runs is only captured
+    static test_intern_LogCapture output;
+    test_intern_LogCapture *capture = log_data.capture;
+    bool is_capture_streamed = log_data.is_capture_streamed;
+    memset(&output, 0, sizeof(output));
+    log_data.capture = &output;
+    log_data.is_capture_streamed = false;
+    test_repeat_run_all();
+    log_data.capture = capture;
+    log_data.is_capture_streamed = is_capture_streamed;
+
+    const test_intern_RepeatStats *exited = &test_runner.repeat_stats[0];
+    test_assert_eq(exited->runs, 0);
+    test_assert_eq(exited->crashed_runs, 2);
+    test_assert_string_eq(test_repeat_status(exited), "failing");
+    test_assert(strstr(output.buffer, "0/2 runs passed, worker 0 exited with status 3") != NULL);
+
+    const test_intern_RepeatStats *never = &test_runner.repeat_stats[1];
+    test_assert_eq(never->runs + never->crashed_runs, 0);
+    test_assert_eq(test_repeat_result(never), test_intern_ResultSkipped);
+    test_assert_eq(test_runner.tests_skipped, 1);
+    test_assert_eq(test_runner.tests_failed, 1);
+}
+
+TEST(repeats, workers) {
+    internal_save_state();
+
+    repeat_until_fail(_result);
+    if (*_result != test_intern_ResultFailed) {
+        repeat_workers_exit(_result);
+    }
+
+    free(test_runner.repeat_stats);
+    internal_restore_state();
+}
+
+/* CPU lists */
+static bool cpus_parse_list(const char *text, const uint16_t *expected, uint32_t count) {
+    if (!test_parse_cpus(text) || options.cpu_count != count ||
+        (uint32_t)CPU_COUNT(&options.cpu_set) != count) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (options.cpu_list[i] != expected[i] || !CPU_ISSET(expected[i], &options.cpu_set)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void cpus_parse(test_intern_Result *_result) {
+    static const uint16_t ranges[] = { 0, 1, 2, 3, 6 };
+    test_assert(cpus_parse_list("0-3,6", ranges, 5));
+    static const uint16_t single[] = { 5 };
+    test_assert(cpus_parse_list("5", single, 1));
+    test_assert(cpus_parse_list("5-5", single, 1));
+
+    // Duplicates are only listed once, in the order they first appear
+    static const uint16_t duplicates[] = { 2, 1, 3 };
+    test_assert(cpus_parse_list("2,1-3,2,3", duplicates, 3));
+
+    static const uint16_t last[] = { CPU_SETSIZE - 1 };
+    char text[32];
+    snprintf(text, sizeof(text), "%d", CPU_SETSIZE - 1);
+    test_assert(cpus_parse_list(text, last, 1));
+
+    snprintf(text, sizeof(text), "%d", CPU_SETSIZE);
+    test_assert(!test_parse_cpus(text));
+    snprintf(text, sizeof(text), "0-%d", CPU_SETSIZE);
+    test_assert(!test_parse_cpus(text));
+
+    static const char *invalid[] = {
+        "", "3-1", "1-", "-1", "0,", ",0", "0,,1", "0-1-2", "a", "1 ", " 1", "+1", "1-+2",
+        "99999999999999999999",
+    };
+    for (uint32_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        test_assert(!test_parse_cpus(invalid[i]));
+    }
+
+    // Workers are pinned round robin, in the order of the list
+    test_assert(test_parse_cpus("6,0-1"));
+    static const uint16_t worker_cpus[] = { 6, 0, 1, 6, 0, 1, 6 };
+    for (uint32_t i = 0; i < sizeof(worker_cpus) / sizeof(worker_cpus[0]); i++) {
+        test_assert_eq(test_worker_cpu(i), worker_cpus[i]);
+    }
+}
+
+SUIT(cpus, NULL, NULL);
+TEST(cpus, parse) {
+    internal_save_state();
+    cpus_parse(_result);
+    internal_restore_state();
+}
+
+/* Logging */
+static void logging_buffered_capture(test_intern_Result *_result) {
+    static test_intern_LogCapture capture;
+    memset(&capture, 0, sizeof(capture));
+    log_data.capture = &capture;
+    log_data.is_capture_streamed = false;
+
+    for (uint32_t i = 0; i < 40; i++) {
+        test_log_write("line %02u of a test case with a lot of output\n", i);
+    }
+    test_log_write("failed at %u: assertion\n", 42);
+
+    log_data.capture = NULL;
+
+    // The most recent output is kept, instead of the first kilobyte
+    test_assert(capture.length < TEST_LOG_BUFFER_SIZE);
+    test_assert_eq(strlen(capture.buffer), capture.length);
+    test_assert(strstr(capture.buffer, "line 39 of a test case") != NULL);
+    const char *message = "failed at 42: assertion\n";
+    test_assert_string_eq(capture.buffer + capture.length - strlen(message), message);
+}
+
+SUIT(logging, NULL, NULL);
+TEST(logging, buffered_capture) {
+    internal_save_state();
+    logging_buffered_capture(_result);
+    internal_restore_state();
+}
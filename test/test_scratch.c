@@ -0,0 +1,42 @@
+#include <test/test.h>
+
+#include <stdint.h>
+
+static uint8_t *setup_buffer = NULL;
+static uint8_t *first_buffer = NULL;
+
+static void scratch_setup(void) {
+    setup_buffer = test_scratch_alloc(64);
+    memset(setup_buffer, 0xab, 64);
+}
+
+SUIT(scratch, scratch_setup, NULL);
+TEST(scratch, setup) {
+    test_assert(setup_buffer != NULL);
+    test_assert_eq(setup_buffer[63], 0xab);
+}
+
+TEST(scratch, alignment) {
+    for (size_t size = 1; size < 100; size += 7) {
+        uint8_t *buffer = test_scratch_alloc(size);
+        test_assert_eq((uintptr_t)buffer & 15, 0);
+        test_assert(buffer > setup_buffer);
+        memset(buffer, 0, size);
+    }
+}
+
+// Memory is released after every test case, so the setup always gets the same address.
+// Test cases can run in any order, whichever runs second compares the addresses.
+TEST(scratch, reset_first) {
+    if (first_buffer != NULL) {
+        test_assert(setup_buffer == first_buffer);
+    }
+    first_buffer = setup_buffer;
+}
+
+TEST(scratch, reset_second) {
+    if (first_buffer != NULL) {
+        test_assert(setup_buffer == first_buffer);
+    }
+    first_buffer = setup_buffer;
+}